@@ -62,6 +62,85 @@ int main(int argc, char* argv[]) {
 
 	std::cout << "Expected " << number_of_allocations << " \tFound:" << buffers.size() << "\n";
 
+	// Free every other buffer and look for the gaps
+
+	for(uint_64_t i=0;i<number_of_allocations; i+=2)
+		a.deallocate_by_addr(1024*1024*i);
+
+	std::vector<yamm_access> ranges = a.get_free_ranges(0, custom_size - 1);
+	std::vector<yamm_access> large_ranges = a.get_free_ranges(0, custom_size - 1, 2*1024*1024);
+	std::vector<yamm_access> aligned_ranges = a.get_free_ranges(0, custom_size - 1, 1024*1024, 1024*1024);
+
+	std::cout << "Getting the free ranges in the memory\n";
+	std::cout << "Expected " << number_of_allocations / 2 << " \tFound:" << ranges.size() << "\n";
+	std::cout << "Expected 0 \tFound:" << large_ranges.size() << "\n";
+	std::cout << "Expected " << number_of_allocations / 2 << " \tFound:" << aligned_ranges.size() << "\n";
+
+	// Check an access that ends in each buffer, in reverse order
+
+	std::vector<yamm_access> accesses;
+	for(uint_64_t i=number_of_allocations;i>0; --i)
+		accesses.push_back(yamm_access(1024*1024*i - 2, 2));
+
+	std::vector<yamm_buffer*> overlapping_buffers;
+	std::vector<bool> overlaps = a.access_overlaps(accesses, overlapping_buffers);
+
+	uint_64_t number_of_overlaps = 0;
+	for(uint_64_t i=0;i<overlaps.size(); ++i)
+		if (overlaps[i])
+			number_of_overlaps++;
+
+	std::cout << "Checking the overlaps of the accesses\n";
+	std::cout << "Expected " << number_of_allocations / 2 << " \tFound:" << number_of_overlaps << "\n";
+
+	// Look for the free slots of a slab, the query mustn't change it
+
+	yamm b;
+	b.build(64*1024);
+
+	yamm_buffer* slab = b.allocate_by_size(4096, YAMM_FIRST_FIT);
+	slab->make_slab(64);
+	slab->allocate_by_size(64, YAMM_FIRST_FIT);
+
+	std::vector<yamm_access> slot_ranges = slab->get_free_ranges(0, 64*1024 - 1);
+
+	std::cout << "Getting the free slots of a slab\n";
+	std::cout << "Expected 63 \tFound:" << slot_ranges.size() << "\n";
+	std::cout << "Expected 4032 free bytes \tFound:" << slab->get_free_bytes() << "\n";
+	std::cout << "Expected 64 used bytes \tFound:" << slab->get_used_bytes() << "\n";
+
+	if ((slot_ranges.size() != 63) || (slab->get_free_bytes() != 4032)
+			|| (!b.check_address_space_consistency())) {
+		std::cout << "\n\n\nFree ranges FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// Check accesses against a slab that doesn't start at 0, one of them starts before it
+
+	yamm_buffer* second_slab = b.allocate_by_size(4096, YAMM_FIRST_FIT);
+	second_slab->make_slab(64);
+	second_slab->allocate_by_size(64, YAMM_FIRST_FIT);
+
+	std::vector<yamm_access> slab_accesses;
+	slab_accesses.push_back(yamm_access(second_slab->get_start_addr() + 64, 64));
+	slab_accesses.push_back(yamm_access(0, second_slab->get_start_addr() + 1));
+	slab_accesses.push_back(yamm_access(second_slab->get_end_addr(), 2));
+
+	std::vector<bool> slab_overlaps = second_slab->access_overlaps(slab_accesses,
+			overlapping_buffers);
+
+	std::cout << "Checking the overlaps of the accesses to a slab\n";
+	std::cout << "Expected 0 1 0 \tFound:" << slab_overlaps[0] << " "
+			<< slab_overlaps[1] << " " << slab_overlaps[2] << "\n";
+	std::cout << "Expected 4032 free bytes \tFound:" << second_slab->get_free_bytes() << "\n";
+
+	if ((slab_overlaps[0]) || (!slab_overlaps[1]) || (slab_overlaps[2])
+			|| (second_slab->get_free_bytes() != 4032)
+			|| (!b.check_address_space_consistency())) {
+		std::cout << "\n\n\nOverlaps FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
 	delete acs;
 	return 0;
 
@@ -0,0 +1,693 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef __yamm_benchmark_suite
+#define __yamm_benchmark_suite
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <algorithm>
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+/**
+ * Parameters of one benchmark run
+ */
+class yamm_benchmark_scenario {
+public:
+
+	/** Name printed in the results */
+	std::string name;
+	/** Size of the top level memory */
+	uint_64_t memory_size;
+	/** Buffers allocated before the mixed operations */
+	uint_64_t number_of_buffers;
+	/** Smallest buffer size */
+	uint_64_t min_size;
+	/** Largest buffer size */
+	uint_64_t max_size;
+	/** Start address alignment of the buffers */
+	uint_64_t alignment;
+	/** Number of nested buffers the memory map is in, 0 for the top level */
+	uint depth;
+	/** Percentage of deallocations among the mixed operations, the rest are allocations */
+	uint free_percent;
+	/** Number of mixed operations and of lookups */
+	uint_64_t number_of_operations;
+	/** One of the YAMM_*_FIT modes */
+	int allocation_mode;
+
+	yamm_benchmark_scenario(std::string name, uint_64_t number_of_buffers,
+			uint_64_t min_size, uint_64_t max_size) {
+		this->name = name;
+		this->memory_size = 1024 * 1024 * 1024;
+		this->number_of_buffers = number_of_buffers;
+		this->min_size = min_size;
+		this->max_size = max_size;
+		this->alignment = 1;
+		this->depth = 0;
+		this->free_percent = 50;
+		this->number_of_operations = 10000;
+		this->allocation_mode = YAMM_FIRST_FIT;
+	}
+
+};
+
+/**
+ * Durations of one operation in one scenario
+ */
+class yamm_benchmark_result {
+public:
+
+	yamm_benchmark_scenario scenario;
+	/** allocate, deallocate, lookup, insert, soft_reset, hard_reset or one of the
+	 * bulk operations: populate, compact, resize, slab_allocate, slab_deallocate,
+	 * insert_batch or diff */
+	std::string operation;
+	/** Duration of each call in nanoseconds */
+	std::vector<uint_64_t> samples;
+	/** Calls that returned a failure, they are timed too */
+	uint_64_t number_of_failures;
+
+	yamm_benchmark_result(const yamm_benchmark_scenario &scenario,
+			std::string operation) :
+			scenario(scenario) {
+		this->operation = operation;
+		this->number_of_failures = 0;
+	}
+
+	/**
+	 *  Returns the sample below which a fraction of the samples are, by nearest rank.
+	 *  The samples have to be sorted.
+	 */
+	uint_64_t get_percentile(double fraction) const {
+		if (samples.empty())
+			return 0;
+		uint_64_t rank = (uint_64_t) (fraction * samples.size() + 0.999999);
+		return samples[rank ? rank - 1 : 0];
+	}
+
+	double get_mean() const {
+		if (samples.empty())
+			return 0;
+		double total = 0;
+		for (uint_64_t i = 0; i < samples.size(); ++i)
+			total += samples[i];
+		return total / samples.size();
+	}
+
+};
+
+/** Names of the columns written to the CSV file, the same keys are used in the JSON file */
+static const char* yamm_benchmark_columns =
+		"scenario,allocation_mode,memory_size,number_of_buffers,min_size,max_size,alignment,depth,free_percent,operation,count,failures,mean_ns,p50_ns,p90_ns,p99_ns,max_ns";
+
+/**
+ *  Times one call in nanoseconds
+ */
+static inline uint_64_t elapsed_ns(
+		const std::chrono::steady_clock::time_point &begin_time) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - begin_time).count();
+}
+
+/**
+ *  Allocates a buffer in the scenario's mode and records the time in result
+ */
+static yamm_buffer* timed_allocate(yamm_buffer* container,
+		const yamm_benchmark_scenario &scenario, yamm_size_distribution &sizes,
+		yamm_benchmark_result &result) {
+
+	yamm_buffer* new_buffer = new yamm_buffer(sizes.next_size());
+	new_buffer->set_start_addr_alignment(scenario.alignment);
+
+	std::chrono::steady_clock::time_point begin_time =
+			std::chrono::steady_clock::now();
+	bool allocated = container->allocate(new_buffer, scenario.allocation_mode);
+	result.samples.push_back(elapsed_ns(begin_time));
+
+	if (allocated)
+		return new_buffer;
+
+	result.number_of_failures++;
+	delete new_buffer;
+	return NULL;
+}
+
+/**
+ *  Times the operations that work on many buffers at once, or on a slab, in the
+ *  scenario's mode. The memory is filled to hold number_of_buffers buffers on average,
+ *  in 10 calls of populate(), then half of the buffers are freed and the memory is
+ *  compacted 5 times, and the buffers left are resized. A slab big enough for
+ *  number_of_buffers buffers is filled and emptied. Then regions are inserted in
+ *  batches of 1000 and 10 snapshots are compared with the memory after freeing
+ *  10 regions. The memory is empty when it returns.
+ */
+static void run_bulk_operations(const yamm_benchmark_scenario &scenario,
+		yamm_buffer* container, std::vector<yamm_benchmark_result> &results) {
+
+	yamm_benchmark_result populates(scenario, "populate");
+	yamm_benchmark_result compacts(scenario, "compact");
+	yamm_benchmark_result resizes(scenario, "resize");
+	yamm_benchmark_result slab_allocations(scenario, "slab_allocate");
+	yamm_benchmark_result slab_deallocations(scenario, "slab_deallocate");
+	yamm_benchmark_result batch_inserts(scenario, "insert_batch");
+	yamm_benchmark_result diffs(scenario, "diff");
+
+	yamm_size_distribution sizes(scenario.min_size, scenario.max_size);
+	uint_64_t average_size = (scenario.min_size + scenario.max_size) / 2;
+	std::chrono::steady_clock::time_point begin_time;
+
+	double target_usage = 100.0 * scenario.number_of_buffers * average_size
+			/ container->get_size();
+	if (target_usage > 90)
+		target_usage = 90;
+
+	std::vector<yamm_buffer*> buffers;
+	for (uint step = 1; step <= 10; ++step) {
+		begin_time = std::chrono::steady_clock::now();
+		std::vector<yamm_buffer*> added = container->populate(
+				target_usage * step / 10, sizes, scenario.allocation_mode);
+		populates.samples.push_back(elapsed_ns(begin_time));
+
+		if (container->get_usage_statistics() < target_usage * step / 10)
+			populates.number_of_failures++;
+		buffers.insert(buffers.end(), added.begin(), added.end());
+	}
+
+	for (uint round = 0; round < 5; ++round) {
+
+		std::vector<yamm_buffer*> kept;
+		for (uint_64_t i = 0; i < buffers.size(); ++i)
+			if (i % 2)
+				kept.push_back(buffers[i]);
+			else
+				container->deallocate(buffers[i]);
+		buffers = kept;
+
+		begin_time = std::chrono::steady_clock::now();
+		container->compact();
+		compacts.samples.push_back(elapsed_ns(begin_time));
+
+		std::vector<yamm_buffer*> added = container->populate(target_usage,
+				sizes, scenario.allocation_mode);
+		buffers.insert(buffers.end(), added.begin(), added.end());
+	}
+
+	for (uint_64_t i = 0; (i < scenario.number_of_operations) && (!buffers.empty());
+			++i) {
+		yamm_buffer* buffer = buffers[rand() % buffers.size()];
+		uint_64_t new_size = sizes.next_size();
+
+		begin_time = std::chrono::steady_clock::now();
+		bool resized = container->resize(buffer, new_size,
+				scenario.allocation_mode);
+		resizes.samples.push_back(elapsed_ns(begin_time));
+
+		if (!resized)
+			resizes.number_of_failures++;
+	}
+
+	container->hard_reset();
+
+	// Each slot holds the largest buffer and respects the alignment
+	uint_64_t slot_size = (scenario.max_size + scenario.alignment - 1)
+			/ scenario.alignment * scenario.alignment;
+	yamm_buffer* slab = new yamm_buffer(scenario.number_of_buffers * slot_size);
+	slab->set_start_addr_alignment(scenario.alignment);
+
+	if ((container->allocate(slab, YAMM_FIRST_FIT)) && (slab->make_slab(slot_size))) {
+
+		std::vector<yamm_buffer*> slots;
+		for (uint_64_t i = 0; i < scenario.number_of_buffers; ++i) {
+			yamm_buffer* new_buffer = timed_allocate(slab, scenario, sizes,
+					slab_allocations);
+			if (new_buffer)
+				slots.push_back(new_buffer);
+		}
+
+		std::random_shuffle(slots.begin(), slots.end());
+		for (uint_64_t i = 0; i < slots.size(); ++i) {
+			begin_time = std::chrono::steady_clock::now();
+			bool deallocated = slab->deallocate(slots[i]);
+			slab_deallocations.samples.push_back(elapsed_ns(begin_time));
+
+			if (!deallocated)
+				slab_deallocations.number_of_failures++;
+		}
+	} else
+		slab_allocations.number_of_failures++;
+
+	container->hard_reset();
+
+	// Every other region of average_size bytes, the ones that fit in the memory
+	std::vector<yamm_buffer*> regions;
+	for (uint_64_t i = 0; (i < scenario.number_of_buffers)
+			&& ((i * 2 + 1) * average_size <= container->get_size()); ++i)
+		regions.push_back(
+				new yamm_buffer(container->get_start_addr() + i * 2 * average_size,
+						average_size));
+	std::random_shuffle(regions.begin(), regions.end());
+
+	std::vector<yamm_buffer*> inserted;
+	for (uint_64_t i = 0; i < regions.size(); i += 1000) {
+		std::vector<yamm_buffer*> batch(regions.begin() + i,
+				regions.begin() + std::min(i + 1000, (uint_64_t) regions.size()));
+
+		begin_time = std::chrono::steady_clock::now();
+		std::vector<bool> batch_inserted = container->insert_batch(batch);
+		batch_inserts.samples.push_back(elapsed_ns(begin_time));
+
+		for (uint_64_t j = 0; j < batch.size(); ++j)
+			if (batch_inserted[j])
+				inserted.push_back(batch[j]);
+			else {
+				batch_inserts.number_of_failures++;
+				delete batch[j];
+			}
+	}
+
+	for (uint round = 0; round < 10; ++round) {
+
+		yamm_buffer* before = container->snapshot();
+		for (uint i = 0; (i < 10) && (!inserted.empty()); ++i) {
+			uint_64_t index = rand() % inserted.size();
+			container->deallocate(inserted[index]);
+			inserted[index] = inserted.back();
+			inserted.pop_back();
+		}
+
+		begin_time = std::chrono::steady_clock::now();
+		std::vector<yamm_diff> differences = yamm_buffer::diff(before,
+				container);
+		diffs.samples.push_back(elapsed_ns(begin_time));
+
+		if (differences.empty())
+			diffs.number_of_failures++;
+		delete before;
+	}
+
+	container->hard_reset();
+
+	results.push_back(populates);
+	results.push_back(compacts);
+	results.push_back(resizes);
+	results.push_back(slab_allocations);
+	results.push_back(slab_deallocations);
+	results.push_back(batch_inserts);
+	results.push_back(diffs);
+}
+
+/**
+ *  Runs one scenario: fill the memory, look up addresses, mix allocations with
+ *  deallocations, reset, insert the buffers back, reset again and run the bulk
+ *  operations.
+ */
+static void run_scenario(const yamm_benchmark_scenario &scenario,
+		std::vector<yamm_benchmark_result> &results) {
+
+	yamm_benchmark_result allocations(scenario, "allocate");
+	yamm_benchmark_result deallocations(scenario, "deallocate");
+	yamm_benchmark_result lookups(scenario, "lookup");
+	yamm_benchmark_result inserts(scenario, "insert");
+	yamm_benchmark_result soft_resets(scenario, "soft_reset");
+	yamm_benchmark_result hard_resets(scenario, "hard_reset");
+
+	yamm memory;
+	memory.build(scenario.memory_size);
+
+	// Each level takes half of the one that contains it
+	yamm_buffer* container = &memory;
+	for (uint level = 0; level < scenario.depth; ++level) {
+		yamm_buffer* nested = container->allocate_by_size(
+				container->get_size() / 2, YAMM_FIRST_FIT);
+		if (!nested) {
+			std::cout << "Scenario " << scenario.name << " can't nest "
+					<< scenario.depth << " levels in " << scenario.memory_size
+					<< " bytes\n";
+			return;
+		}
+		container = nested;
+	}
+
+	container->disable_warnings = 1;
+	container->disable_info = 1;
+
+	yamm_size_distribution sizes(scenario.min_size, scenario.max_size);
+	std::vector<yamm_buffer*> buffers;
+
+	for (uint_64_t i = 0; i < scenario.number_of_buffers; ++i) {
+		yamm_buffer* new_buffer = timed_allocate(container, scenario, sizes,
+				allocations);
+		if (new_buffer)
+			buffers.push_back(new_buffer);
+	}
+
+	// An address inside a random buffer
+	for (uint_64_t i = 0; (i < scenario.number_of_operations) && (!buffers.empty());
+			++i) {
+		yamm_buffer* buffer = buffers[rand() % buffers.size()];
+		uint_64_t address = buffer->get_start_addr()
+				+ rand() % buffer->get_size();
+
+		std::chrono::steady_clock::time_point begin_time =
+				std::chrono::steady_clock::now();
+		yamm_buffer* found = container->get_buffer(address);
+		lookups.samples.push_back(elapsed_ns(begin_time));
+
+		if (found != buffer)
+			lookups.number_of_failures++;
+	}
+
+	for (uint_64_t i = 0; i < scenario.number_of_operations; ++i) {
+
+		if ((!buffers.empty()) && ((uint) (rand() % 100) < scenario.free_percent)) {
+			uint_64_t index = rand() % buffers.size();
+			yamm_buffer* buffer = buffers[index];
+			buffers[index] = buffers.back();
+			buffers.pop_back();
+
+			std::chrono::steady_clock::time_point begin_time =
+					std::chrono::steady_clock::now();
+			bool deallocated = container->deallocate(buffer);
+			deallocations.samples.push_back(elapsed_ns(begin_time));
+
+			if (!deallocated)
+				deallocations.number_of_failures++;
+		} else {
+			yamm_buffer* new_buffer = timed_allocate(container, scenario, sizes,
+					allocations);
+			if (new_buffer)
+				buffers.push_back(new_buffer);
+		}
+	}
+
+	// The same buffers are inserted back at their addresses
+	std::vector<std::pair<uint_64_t, uint_64_t> > places;
+	for (uint_64_t i = 0; i < buffers.size(); ++i)
+		places.push_back(
+				std::make_pair(buffers[i]->get_start_addr(),
+						buffers[i]->get_size()));
+	std::random_shuffle(places.begin(), places.end());
+
+	std::chrono::steady_clock::time_point begin_time =
+			std::chrono::steady_clock::now();
+	container->soft_reset();
+	soft_resets.samples.push_back(elapsed_ns(begin_time));
+
+	for (uint_64_t i = 0; i < places.size(); ++i) {
+		yamm_buffer* new_buffer = new yamm_buffer(places[i].first,
+				places[i].second);
+
+		begin_time = std::chrono::steady_clock::now();
+		bool inserted = container->insert(new_buffer);
+		inserts.samples.push_back(elapsed_ns(begin_time));
+
+		if (!inserted) {
+			inserts.number_of_failures++;
+			delete new_buffer;
+		}
+	}
+
+	begin_time = std::chrono::steady_clock::now();
+	container->hard_reset();
+	hard_resets.samples.push_back(elapsed_ns(begin_time));
+
+	std::vector<yamm_benchmark_result> bulk_results;
+	run_bulk_operations(scenario, container, bulk_results);
+
+	if (!memory.check_address_space_consistency()) {
+		std::cout << "\n\n\nConsistency FAIL in scenario " << scenario.name
+				<< "!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
+	results.push_back(allocations);
+	results.push_back(deallocations);
+	results.push_back(lookups);
+	results.push_back(inserts);
+	results.push_back(soft_resets);
+	results.push_back(hard_resets);
+	results.insert(results.end(), bulk_results.begin(), bulk_results.end());
+}
+
+/**
+ *  Merges the results of the repetitions of a scenario and sorts the samples
+ */
+static std::vector<yamm_benchmark_result> merge_results(
+		std::vector<yamm_benchmark_result> &results, uint repetitions) {
+
+	std::vector<yamm_benchmark_result> merged;
+	uint_64_t per_run = results.size() / repetitions;
+
+	for (uint_64_t i = 0; i < per_run; ++i) {
+		merged.push_back(results[i]);
+		for (uint run = 1; run < repetitions; ++run) {
+			yamm_benchmark_result &other = results[run * per_run + i];
+			merged.back().samples.insert(merged.back().samples.end(),
+					other.samples.begin(), other.samples.end());
+			merged.back().number_of_failures += other.number_of_failures;
+		}
+		std::sort(merged.back().samples.begin(), merged.back().samples.end());
+	}
+
+	return merged;
+}
+
+/**
+ *  Writes the values of the columns, quoted for JSON or not for CSV
+ */
+static void write_row(std::ostream &out, const yamm_benchmark_result &result,
+		bool json) {
+
+	const yamm_benchmark_scenario &scenario = result.scenario;
+	std::ostringstream values;
+	values.precision(1);
+	values << std::fixed;
+
+	values << (json ? "\"" : "") << scenario.name << (json ? "\"" : "") << ","
+			<< scenario.allocation_mode << "," << scenario.memory_size << ","
+			<< scenario.number_of_buffers << "," << scenario.min_size << ","
+			<< scenario.max_size << "," << scenario.alignment << ","
+			<< scenario.depth << "," << scenario.free_percent << ","
+			<< (json ? "\"" : "") << result.operation << (json ? "\"" : "")
+			<< "," << result.samples.size() << "," << result.number_of_failures
+			<< "," << result.get_mean() << "," << result.get_percentile(0.5)
+			<< "," << result.get_percentile(0.9) << ","
+			<< result.get_percentile(0.99) << ","
+			<< (result.samples.empty() ? 0 : result.samples.back());
+
+	if (!json) {
+		out << values.str() << "\n";
+		return;
+	}
+
+	// Pair each value with the name of its column
+	std::istringstream names(yamm_benchmark_columns);
+	std::istringstream fields(values.str());
+	std::string name;
+	std::string field;
+	bool first_field = 1;
+
+	out << "    {";
+	while ((std::getline(names, name, ',')) && (std::getline(fields, field, ','))) {
+		out << (first_field ? "" : ", ") << "\"" << name << "\": " << field;
+		first_field = 0;
+	}
+	out << "}";
+}
+
+static void print_help() {
+	std::cout << "Runs the benchmark scenarios in each allocation mode and reports the\n"
+			<< "duration of each operation in nanoseconds.\n\n"
+			<< "Any of these options replaces the default scenarios with one:\n"
+			<< "  -size N        size of the memory, default 1GB\n"
+			<< "  -buffers N     buffers allocated before the mixed operations\n"
+			<< "  -min_size N    smallest buffer size\n"
+			<< "  -max_size N    largest buffer size\n"
+			<< "  -alignment N   start address alignment\n"
+			<< "  -depth N       number of nested buffers the memory map is in\n"
+			<< "  -free N        percentage of deallocations in the mixed operations\n"
+			<< "  -ops N         number of mixed operations and of lookups\n\n"
+			<< "Other options:\n"
+			<< "  -mode N        only run allocation mode N (YAMM_*_FIT)\n"
+			<< "  -repeat N      run each scenario N times, default 1\n"
+			<< "  -seed N        seed of rand(), default the time\n"
+			<< "  -json FILE     write the results to a JSON file\n"
+			<< "  -csv FILE      write the results to a CSV file\n";
+}
+
+int main(int argc, char* argv[]) {
+
+	std::vector<yamm_benchmark_scenario> scenarios;
+	scenarios.push_back(yamm_benchmark_scenario("small", 10000, 16, 4096));
+	scenarios.push_back(
+			yamm_benchmark_scenario("large", 2000, 64 * 1024, 256 * 1024));
+	scenarios.push_back(yamm_benchmark_scenario("aligned", 10000, 16, 4096));
+	scenarios.back().alignment = 4096;
+	scenarios.push_back(yamm_benchmark_scenario("nested", 10000, 16, 4096));
+	scenarios.back().depth = 3;
+
+	yamm_benchmark_scenario custom("custom", 10000, 16, 4096);
+	bool is_custom = 0;
+	int only_mode = -1;
+	uint repetitions = 1;
+	int seed = time(NULL);
+	std::string json_file;
+	std::string csv_file;
+
+	for (int i = 1; i < argc; ++i) {
+
+		std::string option = argv[i];
+
+		if ((option == "-help") || (option == "-h")) {
+			print_help();
+			return 0;
+		}
+
+		if (i + 1 >= argc) {
+			std::cout << "Option " << option << " needs a value, see -help\n";
+			return 1;
+		}
+
+		std::string value = argv[++i];
+		uint_64_t number = strtoull(value.c_str(), NULL, 0);
+
+		if (option == "-json")
+			json_file = value;
+		else if (option == "-csv")
+			csv_file = value;
+		else if (option == "-mode")
+			only_mode = number;
+		else if (option == "-repeat")
+			repetitions = number ? number : 1;
+		else if (option == "-seed")
+			seed = number;
+		else {
+			is_custom = 1;
+			if (option == "-size")
+				custom.memory_size = number;
+			else if (option == "-buffers")
+				custom.number_of_buffers = number;
+			else if (option == "-min_size")
+				custom.min_size = number;
+			else if (option == "-max_size")
+				custom.max_size = number;
+			else if (option == "-alignment")
+				custom.alignment = number ? number : 1;
+			else if (option == "-depth")
+				custom.depth = number;
+			else if (option == "-free")
+				custom.free_percent = number;
+			else if (option == "-ops")
+				custom.number_of_operations = number;
+			else {
+				std::cout << "Unknown option " << option << ", see -help\n";
+				return 1;
+			}
+		}
+	}
+
+	if (is_custom) {
+		scenarios.clear();
+		scenarios.push_back(custom);
+	}
+
+	std::cout << "Seed: " << seed << "\n\n";
+
+	std::vector<yamm_benchmark_result> results;
+
+	for (uint_64_t i = 0; i < scenarios.size(); ++i)
+		for (int mode = 0; mode <= YAMM_RANDOM_ADDR_FIT; ++mode) {
+
+			if ((only_mode >= 0) && (mode != only_mode))
+				continue;
+
+			yamm_benchmark_scenario scenario = scenarios[i];
+			scenario.allocation_mode = mode;
+
+			// Every mode sees the same sizes and operations
+			srand(seed);
+
+			yamm_buffer::reset_perf_counters();
+
+			std::vector<yamm_benchmark_result> runs;
+			for (uint run = 0; run < repetitions; ++run)
+				run_scenario(scenario, runs);
+
+			if (runs.empty())
+				continue;
+
+			std::vector<yamm_benchmark_result> merged = merge_results(runs,
+					repetitions);
+
+			printf("%-8s mode %d\n", scenario.name.c_str(), mode);
+			for (uint_64_t j = 0; j < merged.size(); ++j)
+				printf("  %-11s %8llu calls %6llu failed  mean %10.1f  p50 %8llu  p90 %8llu  p99 %8llu  max %10llu ns\n",
+						merged[j].operation.c_str(),
+						(uint_64_t) merged[j].samples.size(),
+						merged[j].number_of_failures, merged[j].get_mean(),
+						merged[j].get_percentile(0.5),
+						merged[j].get_percentile(0.9),
+						merged[j].get_percentile(0.99),
+						merged[j].samples.empty() ? 0 : merged[j].samples.back());
+
+#ifdef YAMM_PERF_COUNTERS
+			// Where the time went, only counted if the library is compiled with YAMM_PERF_COUNTERS
+			yamm_perf_counters counters = yamm_buffer::get_perf_counters();
+			printf("  Lookups: %llu (%llu failed)  Nodes visited: %llu  Fallbacks: %llu  Splits: %llu  Merges: %llu\n",
+					(uint_64_t) counters.lookups[mode],
+					(uint_64_t) counters.failed_lookups[mode],
+					(uint_64_t) counters.nodes_visited,
+					(uint_64_t) counters.fallbacks, (uint_64_t) counters.splits,
+					(uint_64_t) counters.merges);
+#endif
+
+			results.insert(results.end(), merged.begin(), merged.end());
+		}
+
+	if (!csv_file.empty()) {
+		std::ofstream csv(csv_file.c_str());
+		csv << yamm_benchmark_columns << "\n";
+		for (uint_64_t i = 0; i < results.size(); ++i)
+			write_row(csv, results[i], 0);
+	}
+
+	if (!json_file.empty()) {
+		std::ofstream json(json_file.c_str());
+		json << "{\n  \"seed\": " << seed << ",\n  \"results\": [\n";
+		for (uint_64_t i = 0; i < results.size(); ++i) {
+			write_row(json, results[i], 1);
+			json << ((i + 1 < results.size()) ? ",\n" : "\n");
+		}
+		json << "  ]\n}\n";
+	}
+
+	return 0;
+
+}
+
+#endif // __yamm_benchmark_suite
@@ -0,0 +1,118 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_engine_test
+#define __yamm_engine_test
+
+#include <iostream>
+#include <stdio.h>
+#include <time.h>
+
+#include "yamm.h"
+#include "yamm_engine.h"
+
+using namespace yamm_ns;
+
+/**
+ * Allocates and frees the same sequence with a policy fixed at compile time
+ */
+template<class Policy>
+void run_engine(const char* name) {
+
+	yamm_engine<uint_64_t, Policy> engine;
+	engine.build(64 * 1024 * 1024);
+
+	std::vector<uint_32_t> buffers;
+
+	clock_t start = clock();
+
+	for (int i = 0; i < 20000; ++i) {
+		uint_32_t buffer = engine.allocate(rand() % 1024 + 1, 16, 8);
+		if (buffer == YAMM_NO_EXTENT)
+			continue;
+		buffers.push_back(buffer);
+
+		if (i % 3 == 0) {
+			int index = rand() % buffers.size();
+			engine.deallocate(buffers[index]);
+			buffers[index] = buffers.back();
+			buffers.pop_back();
+		}
+	}
+
+	std::cout << name << ": " << engine.get_number_of_buffers()
+			<< " buffers, " << engine.get_free_bytes() << " free bytes, "
+			<< (clock() - start) * 1000 / CLOCKS_PER_SEC << " ms, consistent: "
+			<< engine.get_map().check_consistency() << "\n";
+}
+
+/**
+ * Fills a 1GB memory with 4KB pages and returns the metadata size
+ */
+template<class AddrT>
+size_t page_map_footprint() {
+
+	yamm_engine<AddrT, yamm_first_fit_policy> engine;
+	engine.build(1024 * 1024 * 1024);
+
+	while (engine.allocate(4 * 1024) != YAMM_NO_EXTENT)
+		;
+
+	return engine.get_memory_usage();
+}
+
+int main(int argc, char* argv[]) {
+
+	srand(1);
+
+	run_engine<yamm_random_fit_policy>("RANDOM_FIT");
+	run_engine<yamm_first_fit_rnd_policy>("FIRST_FIT_RND");
+	run_engine<yamm_best_fit_rnd_policy>("BEST_FIT_RND");
+	run_engine<yamm_first_fit_policy>("FIRST_FIT");
+	run_engine<yamm_best_fit_policy>("BEST_FIT");
+	run_engine<yamm_uniform_fit_policy>("UNIFORM_FIT");
+	run_engine<yamm_random_addr_fit_policy>("RANDOM_ADDR_FIT");
+
+	// A whole 32-bit address space
+	yamm_engine<uint_32_t, yamm_best_fit_policy> engine_32;
+	engine_32.build(0, 0xFFFFFFFF);
+	uint_32_t buffer = engine_32.allocate(0x1000, 0x1000);
+	engine_32.insert_access(yamm_access_32(0x80000000, 0x100));
+
+	std::cout << "32-bit engine: buffer at " << std::hex
+			<< engine_32.get_start_addr(buffer) << ", owner of 0x80000010 at "
+			<< engine_32.get_start_addr(engine_32.find(0x80000010)) << std::dec
+			<< "\n";
+
+	// A 2^64 bytes memory needs 128-bit addresses
+	yamm_engine<uint_128_t, yamm_uniform_fit_policy> engine_128;
+	engine_128.build(((uint_128_t) 1) << 64);
+	buffer = engine_128.allocate(((uint_128_t) 1) << 62, 1024);
+
+	std::cout << "128-bit engine: buffer at 0x" << std::hex
+			<< (uint_64_t) engine_128.get_start_addr(buffer) << std::dec
+			<< "\n";
+
+	std::cout << "Metadata for 1GB of 4KB pages: 32-bit "
+			<< page_map_footprint<uint_32_t>() << " bytes, 64-bit "
+			<< page_map_footprint<uint_64_t>() << " bytes, 128-bit "
+			<< page_map_footprint<uint_128_t>() << " bytes\n";
+
+	return 0;
+}
+
+#endif // __yamm_engine_test
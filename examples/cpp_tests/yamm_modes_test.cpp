@@ -0,0 +1,655 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef __yamm_modes_test
+#define __yamm_modes_test
+
+#include <iostream>
+#include <stdio.h>
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+/**
+ * Exits if the memory map is broken after step
+ */
+static void check_consistency(yamm &memory, const char* step) {
+
+	if (!memory.check_address_space_consistency()) {
+		std::cout << "\n\n\n" << step << " consistency FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+}
+
+/**
+ * Prints what was expected and what was found, exits if they differ
+ */
+static void expect(const char* step, uint_64_t expected, uint_64_t found) {
+
+	std::cout << step << ": Expected 0x" << std::hex << expected << " \tFound:0x"
+			<< found << std::dec << "\n";
+
+	if (expected != found) {
+		std::cout << "\n\n\n" << step << " FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+}
+
+/**
+ * Start address of a buffer, 1 (never aligned in these tests) for a null handle
+ */
+static uint_64_t start_of(yamm_buffer* buffer) {
+	return buffer ? buffer->get_start_addr() : 1;
+}
+
+/**
+ * A 64K memory of 4K buffers with the ones at 0x1000, 0x3000, 0x5000 and 0x9000 freed
+ */
+static void fragment(yamm &memory, std::vector<yamm_buffer*> &buffers) {
+
+	memory.build(64 * 1024);
+
+	for (int i = 0; i < 16; ++i)
+		buffers.push_back(memory.allocate_by_size(0x1000, YAMM_FIRST_FIT));
+
+	memory.deallocate(buffers[1]);
+	memory.deallocate(buffers[3]);
+	memory.deallocate(buffers[5]);
+	memory.deallocate(buffers[9]);
+
+	check_consistency(memory, "Fragmented memory");
+}
+
+/**
+ * allocate_in_range(): the buffer lies in the window, whatever the mode
+ */
+static void test_allocate_in_range() {
+
+	std::cout << "\nAllocation in a window\n";
+
+	yamm memory;
+	std::vector<yamm_buffer*> buffers;
+	fragment(memory, buffers);
+
+	yamm_buffer* first = memory.allocate_by_size_in_range(0x800, YAMM_FIRST_FIT,
+			0x4000, 0x9fff);
+	expect("First fit in [0x4000, 0x9fff]", 0x5000, start_of(first));
+	check_consistency(memory, "First fit in a window");
+
+	// The rest of the free buffer at 0x5800 is the smallest one
+	yamm_buffer* best = memory.allocate_by_size_in_range(0x400, YAMM_BEST_FIT,
+			0x5000, 0xffff);
+	expect("Best fit in [0x5000, 0xffff]", 0x5800, start_of(best));
+	check_consistency(memory, "Best fit in a window");
+
+	// Only the part of the free buffer inside the window is used
+	yamm_buffer* clipped = memory.allocate_by_size_in_range(0x800, YAMM_FIRST_FIT,
+			0x3800, 0x3fff);
+	expect("Free buffer clipped by the window", 0x3800, start_of(clipped));
+	check_consistency(memory, "Clipped window");
+
+	yamm_buffer* aligned = new yamm_buffer(0x100);
+	aligned->set_start_addr_alignment(0x400);
+	expect("Aligned in [0x9100, 0x9fff]", 1,
+			memory.allocate_in_range(aligned, YAMM_FIRST_FIT, 0x9100, 0x9fff));
+	expect("Aligned start address", 0x9400, aligned->get_start_addr());
+	check_consistency(memory, "Aligned in a window");
+
+	// Too small for the buffer, then no free buffer at all
+	memory.disable_warnings = 1;
+	expect("Window smaller than the buffer", 1,
+			start_of(memory.allocate_by_size_in_range(0x800, YAMM_FIRST_FIT,
+					0x3000, 0x36ff)));
+	expect("Window without free buffers", 1,
+			start_of(memory.allocate_by_size_in_range(0x10, YAMM_FIRST_FIT,
+					0x0, 0xfff)));
+	memory.disable_warnings = 0;
+	check_consistency(memory, "Failed allocations in a window");
+
+	int modes[] = { YAMM_RANDOM_FIT, YAMM_FIRST_FIT_RND, YAMM_BEST_FIT_RND,
+			YAMM_FIRST_FIT, YAMM_BEST_FIT, YAMM_UNIFORM_FIT, YAMM_NEXT_FIT,
+			YAMM_RANDOM_ADDR_FIT };
+
+	uint outside = 0;
+	for (uint mode = 0; mode < sizeof(modes) / sizeof(modes[0]); ++mode)
+		for (int i = 0; i < 100; ++i) {
+
+			yamm_buffer* buffer = memory.allocate_by_size_in_range(0x40,
+					modes[mode], 0x3000, 0x37ff);
+
+			if ((!buffer) || (buffer->get_start_addr() < 0x3000)
+					|| (buffer->get_end_addr() > 0x37ff))
+				outside++;
+			else
+				memory.deallocate(buffer);
+		}
+
+	expect("Buffers outside [0x3000, 0x37ff]", 0, outside);
+	check_consistency(memory, "All the modes in a window");
+}
+
+/**
+ * YAMM_BUDDY_FIT: sizes are rounded up to a power of two block, aligned to its size
+ */
+static void test_buddy() {
+
+	std::cout << "\nBuddy allocation\n";
+
+	yamm memory;
+	memory.build(64 * 1024);
+
+	yamm_buffer* rounded = memory.allocate_by_size(3000, YAMM_BUDDY_FIT);
+	expect("Block size for 3000 bytes", 0x1000, rounded ? rounded->get_size() : 0);
+	expect("Block start address", 0, start_of(rounded));
+	check_consistency(memory, "Buddy block");
+
+	// The smallest free block is the buddy of the first one
+	yamm_buffer* buddy = memory.allocate_by_size(0x1000, YAMM_BUDDY_FIT);
+	expect("Buddy of the first block", 0x1000, start_of(buddy));
+	check_consistency(memory, "Buddy of a block");
+
+	// The block is as large as the alignment
+	yamm_buffer* aligned = new yamm_buffer(0x100);
+	aligned->set_start_addr_alignment(0x4000);
+	expect("Aligned buddy allocation", 1,
+			memory.allocate(aligned, YAMM_BUDDY_FIT));
+	expect("Block size for a 16K alignment", 0x4000, aligned->get_size());
+	expect("Aligned block start address", 0x4000, aligned->get_start_addr());
+	check_consistency(memory, "Aligned buddy block");
+
+	// Blocks can't honor an alignment that isn't a power of two
+	uint_64_t free_bytes = memory.get_free_bytes();
+	yamm_buffer* unaligned = new yamm_buffer(0x100);
+	unaligned->set_start_addr_alignment(0x300);
+	memory.disable_warnings = 1;
+	expect("Alignment of 0x300", 0, memory.allocate(unaligned, YAMM_BUDDY_FIT));
+	memory.disable_warnings = 0;
+	expect("Free bytes after the failed allocation", free_bytes,
+			memory.get_free_bytes());
+	delete unaligned;
+	check_consistency(memory, "Failed buddy allocation");
+
+	// Freed blocks merge back into the whole memory
+	memory.deallocate(rounded);
+	memory.deallocate(buddy);
+	memory.deallocate(aligned);
+	yamm_buffer* whole = memory.allocate_by_size(64 * 1024, YAMM_BUDDY_FIT);
+	expect("Whole memory after the blocks merged", 0, start_of(whole));
+	check_consistency(memory, "Merged buddy blocks");
+}
+
+/**
+ * YAMM_TLSF_FIT: the first free buffer of the smallest size class that fits,
+ * not the first free buffer in memory
+ */
+static void test_tlsf() {
+
+	std::cout << "\nTLSF allocation\n";
+
+	yamm memory;
+	memory.build(64 * 1024);
+
+	std::vector<yamm_buffer*> buffers;
+	for (int i = 0; i < 16; ++i)
+		buffers.push_back(memory.allocate_by_size(0x1000, YAMM_FIRST_FIT));
+
+	// Free buffers of 16K at 0x0, 4K at 0x6000 and 8K at 0xa000
+	for (int i = 0; i < 4; ++i)
+		memory.deallocate(buffers[i]);
+	memory.deallocate(buffers[6]);
+	memory.deallocate(buffers[10]);
+	memory.deallocate(buffers[11]);
+	check_consistency(memory, "Free buffers of three sizes");
+
+	yamm_buffer* small = memory.allocate_by_size(0x800, YAMM_TLSF_FIT);
+	expect("2K in the 4K free buffer", 0x6000, start_of(small));
+	expect("Size isn't rounded", 0x800, small ? small->get_size() : 0);
+	check_consistency(memory, "TLSF in the 4K class");
+
+	// The 2K left at 0x6800 is too small
+	yamm_buffer* medium = memory.allocate_by_size(0x1000, YAMM_TLSF_FIT);
+	expect("4K in the 8K free buffer", 0xa000, start_of(medium));
+	check_consistency(memory, "TLSF in the 8K class");
+
+	// The alignment is added to the size searched for
+	yamm_buffer* aligned = new yamm_buffer(0x100);
+	aligned->set_start_addr_alignment(0x1000);
+	expect("Aligned TLSF allocation", 1,
+			memory.allocate(aligned, YAMM_TLSF_FIT));
+	expect("Aligned start address", 0, aligned->get_start_addr() % 0x1000);
+	check_consistency(memory, "Aligned TLSF");
+
+	uint_64_t free_bytes = memory.get_free_bytes();
+	expect("Larger than every free buffer", 1,
+			start_of(memory.allocate_by_size(0x8000, YAMM_TLSF_FIT)));
+	expect("Free bytes after the failed allocation", free_bytes,
+			memory.get_free_bytes());
+	check_consistency(memory, "Failed TLSF allocation");
+
+	// The size classes follow the merges
+	memory.deallocate(small);
+	memory.deallocate(medium);
+	memory.deallocate(aligned);
+	yamm_buffer* merged = memory.allocate_by_size(0x4000, YAMM_TLSF_FIT);
+	expect("16K after the merges", 0, start_of(merged));
+	check_consistency(memory, "TLSF after merges");
+}
+
+/**
+ * YAMM_NEXT_FIT: each search resumes where the previous one ended and wraps around,
+ * in the whole memory and inside a window
+ */
+static void test_next_fit() {
+
+	std::cout << "\nNext fit allocation\n";
+
+	yamm memory;
+	std::vector<yamm_buffer*> buffers;
+	fragment(memory, buffers);
+
+	yamm_buffer* first = memory.allocate_by_size(0x100, YAMM_NEXT_FIT);
+	expect("First search", 0x1000, start_of(first));
+	expect("Resumes after the last buffer", 0x1100,
+			start_of(memory.allocate_by_size(0x100, YAMM_NEXT_FIT)));
+	expect("Skips what is left at 0x1200", 0x3000,
+			start_of(memory.allocate_by_size(0xf00, YAMM_NEXT_FIT)));
+	check_consistency(memory, "Next fit");
+
+	// A buffer freed behind the rover isn't reused before wrapping around
+	memory.deallocate(first);
+	expect("Rest of the free buffer at 0x3f00", 0x3f00,
+			start_of(memory.allocate_by_size(0x100, YAMM_NEXT_FIT)));
+	expect("Free buffer at 0x5000 after the rover", 0x5000,
+			start_of(memory.allocate_by_size(0x100, YAMM_NEXT_FIT)));
+	expect("Last free buffer", 0x9000,
+			start_of(memory.allocate_by_size(0x1000, YAMM_NEXT_FIT)));
+	expect("Wraps around to 0x1200", 0x1200,
+			start_of(memory.allocate_by_size(0x800, YAMM_NEXT_FIT)));
+	check_consistency(memory, "Next fit after wrapping around");
+
+	// Inside a window the rover wraps around to the start of the window
+	yamm window_memory;
+	std::vector<yamm_buffer*> window_buffers;
+	fragment(window_memory, window_buffers);
+
+	expect("First search in [0x2000, 0x6fff]", 0x3000,
+			start_of(window_memory.allocate_by_size_in_range(0x100, YAMM_NEXT_FIT,
+					0x2000, 0x6fff)));
+	expect("Resumes in the window", 0x3100,
+			start_of(window_memory.allocate_by_size_in_range(0x100, YAMM_NEXT_FIT,
+					0x2000, 0x6fff)));
+	expect("Next free buffer in the window", 0x5000,
+			start_of(window_memory.allocate_by_size_in_range(0xf00, YAMM_NEXT_FIT,
+					0x2000, 0x6fff)));
+	expect("Wraps around to the start of the window", 0x3200,
+			start_of(window_memory.allocate_by_size_in_range(0x800, YAMM_NEXT_FIT,
+					0x2000, 0x6fff)));
+	expect("Resumes from the window in the whole memory", 0x9000,
+			start_of(window_memory.allocate_by_size_in_range(0x800, YAMM_NEXT_FIT,
+					0x0, 0xffff)));
+	check_consistency(window_memory, "Next fit in a window");
+}
+
+/**
+ * YAMM_RANDOM_ADDR_FIT: random aligned start addresses, all of them in the window
+ * and spread over all the free buffers that can hold the buffer
+ */
+static void test_random_addr_fit() {
+
+	std::cout << "\nRandom address allocation\n";
+
+	yamm memory;
+	std::vector<yamm_buffer*> buffers;
+	fragment(memory, buffers);
+
+	uint misplaced = 0;
+	uint in_first = 0;
+	uint in_second = 0;
+
+	for (int i = 0; i < 1000; ++i) {
+
+		yamm_buffer* buffer = new yamm_buffer(0x80);
+		buffer->set_start_addr_alignment(0x40);
+
+		if (!memory.allocate_in_range(buffer, YAMM_RANDOM_ADDR_FIT, 0x3010,
+				0x57ff)) {
+			misplaced++;
+			delete buffer;
+			continue;
+		}
+
+		if ((buffer->get_start_addr() < 0x3010)
+				|| (buffer->get_end_addr() > 0x57ff)
+				|| (buffer->get_start_addr() % 0x40))
+			misplaced++;
+		else if (buffer->get_start_addr() < 0x4000)
+			in_first++;
+		else
+			in_second++;
+
+		memory.deallocate(buffer);
+	}
+
+	expect("Misplaced buffers in [0x3010, 0x57ff]", 0, misplaced);
+	expect("Buffers in both free buffers", 1, (in_first > 0) && (in_second > 0));
+	check_consistency(memory, "Random addresses in a window");
+
+	// The whole memory, with an alignment
+	for (int i = 0; i < 1000; ++i) {
+
+		yamm_buffer* buffer = new yamm_buffer(0x100);
+		buffer->set_start_addr_alignment(0x100);
+
+		if (!memory.allocate(buffer, YAMM_RANDOM_ADDR_FIT)) {
+			misplaced++;
+			delete buffer;
+			continue;
+		}
+
+		if (buffer->get_start_addr() % 0x100)
+			misplaced++;
+
+		memory.deallocate(buffer);
+	}
+
+	expect("Misaligned buffers", 0, misplaced);
+	check_consistency(memory, "Random addresses");
+
+	memory.disable_warnings = 1;
+	expect("Larger than the free buffers of the window", 1,
+			start_of(memory.allocate_by_size_in_range(0x1000,
+					YAMM_RANDOM_ADDR_FIT, 0x3010, 0x57ff)));
+	memory.disable_warnings = 0;
+	check_consistency(memory, "Failed random address allocation");
+}
+
+/**
+ * populate(): every mode reaches the target usage and the buffers returned are
+ * in the memory
+ */
+static void test_populate() {
+
+	std::cout << "\nPopulate\n";
+
+	for (int mode = YAMM_RANDOM_FIT; mode <= YAMM_RANDOM_ADDR_FIT; ++mode) {
+
+		yamm memory;
+		memory.build(1024 * 1024);
+
+		// Some fixed buffers so the free space is fragmented
+		for (uint_64_t addr = 0x10000; addr < 0x100000; addr += 0x30000)
+			memory.insert(new yamm_buffer(addr, 0x1000));
+
+		yamm_size_distribution sizes(64, 4096);
+		std::vector<yamm_buffer*> buffers = memory.populate(60, sizes, mode);
+
+		uint lost = 0;
+		for (uint i = 0; i < buffers.size(); ++i)
+			if (memory.get_buffer(buffers[i]->get_start_addr()) != buffers[i])
+				lost++;
+
+		// Buddy blocks are rounded up so they can go past the target
+		uint_64_t target = 1024 * 1024 * 60 / 100;
+		uint_64_t used = memory.get_used_bytes();
+
+		std::cout << "Mode " << mode << ": ";
+		expect("Target reached", 1, (mode == YAMM_BUDDY_FIT) ?
+				(used >= target) : (used == target));
+		expect("Buffers not found at their address", 0, lost);
+		check_consistency(memory, "Populate");
+
+		// Nothing left to do
+		std::cout << "Mode " << mode << ": ";
+		expect("Buffers added past the target", 0,
+				memory.populate(60, sizes, mode).size());
+	}
+
+	// A full memory
+	yamm memory;
+	memory.build(64 * 1024);
+	yamm_size_distribution sizes(1, 256);
+	memory.populate(100, sizes, YAMM_FIRST_FIT);
+	expect("Free bytes of a full memory", 0, memory.get_free_bytes());
+	check_consistency(memory, "Full memory");
+}
+
+/**
+ * Counts the moves done by compact(), buffers can only move toward low addresses
+ */
+class yamm_move_counter: public yamm_relocation_listener {
+public:
+
+	uint moves;
+	uint wrong_moves;
+
+	yamm_move_counter() {
+		moves = 0;
+		wrong_moves = 0;
+	}
+
+	void buffer_moved(yamm_buffer* buffer, uint_64_t old_start_addr) {
+		moves++;
+		if (buffer->get_start_addr() >= old_start_addr)
+			wrong_moves++;
+	}
+};
+
+/**
+ * compact(): the movable buffers slide down keeping their contents and their order,
+ * the inserted ones stay in place
+ */
+static void test_compact() {
+
+	std::cout << "\nCompaction\n";
+
+	yamm memory;
+	memory.build(64 * 1024);
+
+	std::vector<yamm_buffer*> buffers;
+	for (int i = 0; i < 32; ++i) {
+		yamm_buffer* buffer = memory.allocate_by_size(0x300, YAMM_FIRST_FIT);
+		std::vector<char> payload(0x300, 'a' + i % 26);
+		buffer->set_contents(&payload[0], payload.size());
+		buffers.push_back(buffer);
+	}
+
+	yamm_buffer* fixed = new yamm_buffer(0xc000, 0x100);
+	memory.insert(fixed);
+
+	for (int i = 0; i < 32; i += 2)
+		memory.deallocate(buffers[i]);
+	check_consistency(memory, "Memory to compact");
+
+	// One move at a time, then the rest
+	yamm_move_counter counter;
+	expect("Moves with a limit of one", 1, memory.compact(&counter, 1));
+	check_consistency(memory, "One move");
+
+	uint moves = memory.compact(&counter);
+	expect("Moves reported to the listener", moves + 1, counter.moves);
+	expect("Moves toward high addresses", 0, counter.wrong_moves);
+	expect("Moves once compacted", 0, memory.compact(&counter));
+	check_consistency(memory, "Compacted memory");
+
+	uint wrong_contents = 0;
+	uint_64_t next_addr = 0;
+	for (int i = 1; i < 32; i += 2) {
+
+		std::vector<char> payload(0x300, 'a' + i % 26);
+		if (!buffers[i]->compare_contents(&payload[0], payload.size()))
+			wrong_contents++;
+
+		// Back to back, in the same order
+		if (buffers[i]->get_start_addr() != next_addr)
+			wrong_contents++;
+		next_addr = buffers[i]->get_end_addr() + 1;
+	}
+
+	expect("Buffers with wrong contents or addresses", 0, wrong_contents);
+	expect("Inserted buffer", 0xc000, fixed->get_start_addr());
+	expect("Free buffer gathered before the inserted one", 0xc000 - next_addr,
+			memory.get_largest_free_extent());
+}
+
+/**
+ * resize(): in place when possible, moved with its contents otherwise, unchanged
+ * when it can't grow at all
+ */
+static void test_resize() {
+
+	std::cout << "\nResize\n";
+
+	yamm memory;
+	memory.build(64 * 1024);
+
+	yamm_buffer* resized = memory.allocate_by_size(0x400, YAMM_FIRST_FIT);
+	std::vector<char> payload(0x400);
+	for (uint i = 0; i < payload.size(); ++i)
+		payload[i] = i * 7;
+	resized->set_contents(&payload[0], payload.size());
+
+	yamm_buffer* next = memory.allocate_by_size(0x400, YAMM_FIRST_FIT);
+	memory.allocate_by_size(0x400, YAMM_FIRST_FIT);
+
+	// Shrinks in place, the tail becomes free
+	uint_64_t free_bytes = memory.get_free_bytes();
+	expect("Shrink", 1, memory.resize(resized, 0x200, YAMM_FIRST_FIT));
+	expect("Start address after shrinking", 0, resized->get_start_addr());
+	expect("Size after shrinking", 0x200, resized->get_size());
+	expect("Free bytes after shrinking", free_bytes + 0x200,
+			memory.get_free_bytes());
+	expect("Contents after shrinking", 1,
+			resized->compare_contents(&payload[0], 0x200));
+	check_consistency(memory, "Shrink");
+
+	// Grows back into its old tail
+	expect("Grow in place", 1, memory.resize(resized, 0x400, YAMM_FIRST_FIT));
+	expect("Start address after growing in place", 0, resized->get_start_addr());
+	expect("Contents after growing in place", 1,
+			resized->compare_contents(&payload[0], 0x200));
+	check_consistency(memory, "Grow in place");
+
+	// The next buffer is in the way so it moves to a larger free buffer
+	resized->set_contents(&payload[0], payload.size());
+	expect("Grow past the next buffer", 1,
+			memory.resize(resized, 0x800, YAMM_FIRST_FIT));
+	expect("Moved after the buffers in the way", 0xc00, resized->get_start_addr());
+	expect("Size after moving", 0x800, resized->get_size());
+	expect("Contents after moving", 1,
+			resized->compare_contents(&payload[0], 0x400));
+	expect("Old place is free", 1, memory.get_buffer(0) == NULL);
+	expect("Next buffer stays in place", 0x400, next->get_start_addr());
+	check_consistency(memory, "Grow by moving");
+
+	// An inserted buffer can't move, a buffer can't grow past the memory
+	yamm_buffer* inserted = new yamm_buffer(0x8000, 0x100);
+	memory.insert(inserted);
+	memory.insert(new yamm_buffer(0x8100, 0x100));
+
+	memory.disable_warnings = 1;
+	expect("Grow an inserted buffer in the way", 0,
+			memory.resize(inserted, 0x200, YAMM_FIRST_FIT));
+	expect("Grow past the memory", 0,
+			memory.resize(next, 0x20000, YAMM_FIRST_FIT));
+	memory.disable_warnings = 0;
+
+	expect("Inserted buffer start address", 0x8000, inserted->get_start_addr());
+	expect("Inserted buffer size", 0x100, inserted->get_size());
+	expect("Next buffer size", 0x400, next->get_size());
+	check_consistency(memory, "Failed resize");
+}
+
+/**
+ * insert_batch(): unsorted buffers, the ones that collide with the memory or with
+ * the batch are left out
+ */
+static void test_insert_batch() {
+
+	std::cout << "\nBatch insertion\n";
+
+	yamm memory;
+	memory.build(64 * 1024);
+	memory.insert(new yamm_buffer(0x2000, 0x100));
+
+	std::vector<yamm_buffer*> batch;
+	batch.push_back(new yamm_buffer(0x8000, 0x100));
+	batch.push_back(new yamm_buffer(0x1000, 0x100));
+	batch.push_back(new yamm_buffer(0x2080, 0x100));
+	batch.push_back(new yamm_buffer(0x1080, 0x100));
+	batch.push_back(new yamm_buffer(0xff00, 0x100));
+	batch.push_back(new yamm_buffer(0x3000, 0x1000));
+
+	memory.disable_warnings = 1;
+	std::vector<bool> inserted = memory.insert_batch(batch);
+	memory.disable_warnings = 0;
+
+	uint_64_t found = 0;
+	uint lost = 0;
+	for (uint i = 0; i < inserted.size(); ++i) {
+		found = (found << 1) | inserted[i];
+		if ((inserted[i]) && (memory.get_buffer(batch[i]->get_start_addr())
+				!= batch[i]))
+			lost++;
+	}
+
+	// One bit per buffer, the first one is the highest. The one at 0x2080 collides
+	// with the memory, the one at 0x1080 with the batch
+	expect("Inserted buffers", 0x33, found);
+	expect("Inserted buffers not found at their address", 0, lost);
+	expect("Used bytes", 0x100 * 4 + 0x1000, memory.get_used_bytes());
+	check_consistency(memory, "Batch insertion");
+
+	delete batch[2];
+	delete batch[3];
+
+	std::vector<yamm_access> accesses;
+	accesses.push_back(yamm_access(0x5000, 0x200));
+	accesses.push_back(yamm_access(0x4f00, 0x200));
+	accesses.push_back(yamm_access(0x4000, 0x100));
+
+	memory.disable_warnings = 1;
+	std::vector<yamm_buffer*> buffers = memory.insert_accesses(accesses);
+	memory.disable_warnings = 0;
+
+	// The batch is placed in address order so the access at 0x4f00 comes first
+	expect("Access at 0x5000 colliding with the one at 0x4f00", 1,
+			buffers[0] == NULL);
+	expect("Access at 0x4f00", 0x4f00, start_of(buffers[1]));
+	expect("Access at 0x4000", 0x4000, start_of(buffers[2]));
+	check_consistency(memory, "Access insertion");
+}
+
+int main(int argc, char* argv[]) {
+
+	srand(1);
+
+	test_allocate_in_range();
+	test_buddy();
+	test_tlsf();
+	test_next_fit();
+	test_random_addr_fit();
+	test_populate();
+	test_compact();
+	test_resize();
+	test_insert_batch();
+
+	return 0;
+}
+
+#endif // __yamm_modes_test
@@ -0,0 +1,186 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef __yamm_parallel_check_test
+#define __yamm_parallel_check_test
+
+#include <iostream>
+#include <stdio.h>
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+/**
+ * Breaks memory maps on purpose. A derived class can name the protected
+ * fields of yamm_buffer, so it can point to them in any buffer.
+ */
+class yamm_fault_injector: public yamm_buffer {
+public:
+
+	static yamm_buffer*& next_of(yamm_buffer* buffer) {
+		return buffer->*(&yamm_fault_injector::next);
+	}
+
+	static yamm_buffer*& next_free_of(yamm_buffer* buffer) {
+		return buffer->*(&yamm_fault_injector::next_free);
+	}
+
+	static bool& is_free_of(yamm_buffer* buffer) {
+		return buffer->*(&yamm_fault_injector::is_free);
+	}
+
+	static uint& number_of_buffers_of(yamm_buffer* buffer) {
+		return buffer->*(&yamm_fault_injector::number_of_buffers);
+	}
+
+	static std::vector<uint_64_t>& slab_bitmap_of(yamm_buffer* buffer) {
+		return state_of(buffer)->slab_bitmap;
+	}
+
+	static yamm_container_state* state_of(yamm_buffer* buffer) {
+		return buffer->*(&yamm_fault_injector::container_state);
+	}
+
+};
+
+/**
+ * Checks the memory in parallel and exits if the violation wasn't found
+ */
+static void expect_violation(yamm &memory, int kind, uint level,
+		const char* fault) {
+
+	std::vector<yamm_violation> violations =
+			memory.check_address_space_consistency_parallel(0);
+
+	bool found = 0;
+	for (uint i = 0; i < violations.size(); ++i)
+		if ((violations[i].kind == kind) && (violations[i].level == level))
+			found = 1;
+
+	std::cout << fault << ": " << violations.size() << " violation(s), kind "
+			<< kind << " at level " << level << (found ? " found\n" : " MISSING\n");
+
+	if (!found) {
+		for (uint i = 0; i < violations.size(); ++i)
+			std::cout << "\tKind " << violations[i].kind << " at level "
+					<< violations[i].level << ": " << violations[i].message
+					<< "\n";
+		exit(YAMM_EXIT_CODE);
+	}
+}
+
+/**
+ * Checks the memory in parallel and exits if anything is reported
+ */
+static void expect_consistent(yamm &memory) {
+
+	std::vector<yamm_violation> violations =
+			memory.check_address_space_consistency_parallel(0);
+
+	std::cout << "Consistent memory: " << violations.size()
+			<< " violation(s)\n";
+
+	if (!violations.empty())
+		exit(YAMM_EXIT_CODE);
+}
+
+int main(int argc, char* argv[]) {
+
+	yamm memory;
+	memory.build(1024 * 1024 * 1024);
+
+	// Enough buffers for the top memory map to be split between the threads
+	std::vector<yamm_buffer*> buffers;
+	for (int i = 0; i < 150000; ++i)
+		buffers.push_back(memory.allocate_by_size(4 * 1024, YAMM_FIRST_FIT));
+
+	for (uint i = 0; i < buffers.size(); i += 3)
+		memory.deallocate(buffers[i]);
+
+	// Two levels of recursion inside
+	yamm_buffer* level_1 = buffers[1];
+	std::vector<yamm_buffer*> children;
+	for (int i = 0; i < 4; ++i)
+		children.push_back(level_1->allocate_by_size(512, YAMM_FIRST_FIT));
+
+	yamm_buffer* level_2 = children[0];
+	level_2->allocate_by_size(64, YAMM_FIRST_FIT);
+	level_2->allocate_by_size(64, YAMM_FIRST_FIT);
+
+	level_1->deallocate(children[1]);
+
+	// A slab at level 2 with a few occupied slots
+	yamm_buffer* slab = children[3];
+	slab->make_slab(64);
+	for (int i = 0; i < 3; ++i)
+		slab->allocate_by_size(64, YAMM_FIRST_FIT);
+
+	expect_consistent(memory);
+
+	// A free buffer of the top memory map, far from the start, skips the next one
+	yamm_buffer* free_buffer = yamm_fault_injector::next_of(buffers[99998]);
+	yamm_buffer* skipped = yamm_fault_injector::next_free_of(free_buffer);
+	yamm_fault_injector::next_free_of(free_buffer) =
+			yamm_fault_injector::next_free_of(skipped);
+
+	expect_violation(memory, YAMM_VIOLATION_FREE_LINK, 0, "Broken next_free");
+	yamm_fault_injector::next_free_of(free_buffer) = skipped;
+
+	// The buffer after the one deallocated looks free but isn't merged
+	yamm_fault_injector::is_free_of(children[2]) = 1;
+	expect_violation(memory, YAMM_VIOLATION_FREE_NOT_MERGED, 1,
+			"Unmerged free buffers");
+	yamm_fault_injector::is_free_of(children[2]) = 0;
+
+	// One buffer too many in the deepest memory map
+	yamm_fault_injector::number_of_buffers_of(level_2)++;
+	expect_violation(memory, YAMM_VIOLATION_COUNTER, 2, "Wrong counter");
+	yamm_fault_injector::number_of_buffers_of(level_2)--;
+
+	// A free slot of the slab is marked as occupied in the bitmap
+	yamm_fault_injector::slab_bitmap_of(slab)[0] ^= 1 << 5;
+	expect_violation(memory, YAMM_VIOLATION_SLOT, 2, "Wrong slab bitmap");
+	yamm_fault_injector::slab_bitmap_of(slab)[0] ^= 1 << 5;
+
+	// The free buffer is missing from the index by address of the top memory map
+	yamm_container_state* top = yamm_fault_injector::state_of(&memory);
+	top->free_by_addr.erase(free_buffer->get_start_addr());
+	expect_violation(memory, YAMM_VIOLATION_INDEX, 0, "Free buffer not indexed");
+	top->free_by_addr[free_buffer->get_start_addr()] = free_buffer;
+
+	// One free buffer too many in the histogram of the first recursion level
+	std::vector<uint> &histogram =
+			yamm_fault_injector::state_of(level_1)->free_histogram;
+	histogram[9]++;
+	expect_violation(memory, YAMM_VIOLATION_INDEX, 1, "Wrong free histogram");
+	histogram[9]--;
+
+	// The top memory map counts one byte too many two recursion levels below
+	top->level_statistics[2].used_bytes++;
+	expect_violation(memory, YAMM_VIOLATION_INDEX, 0,
+			"Wrong level statistics");
+	top->level_statistics[2].used_bytes--;
+
+	expect_consistent(memory);
+
+	return 0;
+
+}
+
+#endif // __yamm_parallel_check_test
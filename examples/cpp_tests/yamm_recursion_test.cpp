@@ -25,6 +25,16 @@
 
 using namespace yamm_ns;
 
+/** Prints each change of the memory maps */
+class yamm_print_observer: public yamm_observer {
+public:
+	void notify(const yamm_event &event) {
+		std::cout << "Event " << event.kind << " at level " << event.level
+				<< ": " << event.old_start_addr << " -> " << event.start_addr
+				<< "\n";
+	}
+};
+
 int main(int argc, char* argv[]) {
 
 	yamm my_memory;
@@ -48,11 +58,34 @@ int main(int argc, char* argv[]) {
 	std::cout << "Memory map: \n\n";
 	std::cout << my_memory.sprint(1, 0) << "\n\n\n";
 
+	yamm_buffer* before_reset = my_memory.snapshot();
+
+	yamm_print_observer observer;
+	my_memory.set_observer(&observer);
+
+	std::cout << "Events of a soft reset: \n\n";
 	my_memory.soft_reset();
+	std::cout << "\n\n";
+
+	my_memory.set_observer(NULL);
 
 	std::cout << "Memory after a soft reset: \n\n";
 	std::cout << my_memory.sprint(1, 0) << "\n\n\n";
 
+	// What the soft reset changed
+	std::vector<yamm_diff> differences = yamm_buffer::diff(before_reset,
+			&my_memory);
+
+	std::cout << "Differences after a soft reset: \n\n";
+	for (uint i = 0; i < differences.size(); ++i)
+		std::cout << "Kind " << differences[i].kind << " at level "
+				<< differences[i].level << ": " << differences[i].old_start_addr
+				<< " +" << differences[i].old_size << " -> "
+				<< differences[i].new_start_addr << " +"
+				<< differences[i].new_size << "\n";
+
+	delete before_reset;
+
 }
 
 #endif // __yamm_recursion_test
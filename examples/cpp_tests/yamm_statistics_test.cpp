@@ -0,0 +1,156 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_statistics_test
+#define __yamm_statistics_test
+
+#include <iostream>
+#include <stdio.h>
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+int main(int argc, char* argv[]) {
+
+	yamm my_memory;
+	my_memory.build(1024 * 1024);
+
+	// Fragment the main memory
+	std::vector<yamm_buffer*> buffers;
+	for (int i = 0; i < 64; ++i)
+		buffers.push_back(my_memory.allocate_by_size(4 * 1024, YAMM_UNIFORM_FIT));
+
+	for (int i = 0; i < 64; i += 2)
+		my_memory.deallocate(buffers[i]);
+
+	// Allocate one level of recursion deeper
+	yamm_buffer* x1 = buffers[1];
+	yamm_buffer* x2 = x1->allocate_by_size(1024, YAMM_FIRST_FIT);
+	x1->allocate_by_size(512, YAMM_BEST_FIT);
+	x2->allocate_by_size(64, YAMM_UNIFORM_FIT);
+
+	std::cout << "Main memory\n";
+	std::cout << "Used: " << my_memory.get_usage_statistics() << "%\tFrag: "
+			<< my_memory.get_fragmentation() << "%\tExternal frag: "
+			<< my_memory.get_external_fragmentation() << "%\n";
+	std::cout << "Free bytes: " << my_memory.get_free_bytes()
+			<< "\tLargest free buffer: " << my_memory.get_largest_free_extent()
+			<< "\n";
+	std::cout << "Largest 4K aligned allocation: "
+			<< my_memory.largest_allocatable(4 * 1024, 1) << "\n";
+
+	std::cout << "\nFree buffers by size class\n";
+	std::vector<uint> histogram = my_memory.get_free_histogram();
+	for (uint i = 0; i < histogram.size(); ++i)
+		if (histogram[i])
+			std::cout << "[2^" << i << ", 2^" << i + 1 << "): " << histogram[i]
+					<< "\n";
+
+	std::cout << "\nStatistics per recursion level\n";
+	for (uint level = 0; level < my_memory.get_number_of_levels(); ++level) {
+		yamm_statistics stats = my_memory.get_level_statistics(level);
+		std::cout << "Level " << level << ": " << stats.number_of_buffers
+				<< " used, " << stats.number_of_free_buffers << " free, Used: "
+				<< stats.get_usage_statistics() << "%\n";
+	}
+
+	yamm_statistics tree = my_memory.get_tree_statistics();
+	std::cout << "Whole tree: " << tree.number_of_buffers << " used, "
+			<< tree.number_of_free_buffers << " free, Frag: "
+			<< tree.get_fragmentation() << "%\n";
+
+	if (!my_memory.check_address_space_consistency()) {
+		std::cout << "\n\n\nConsistency FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// The levels below go away with the buffer that contains them
+	my_memory.deallocate(x1);
+
+	std::cout << "\nAfter deallocating the nested buffers: "
+			<< my_memory.get_number_of_levels() << " level(s)\n";
+
+	if ((my_memory.get_number_of_levels() != 1)
+			|| (!my_memory.check_address_space_consistency())) {
+		std::cout << "\n\n\nStatistics FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// Nested again, then everything is freed at once
+	x2 = buffers[3]->allocate_by_size(1024, YAMM_FIRST_FIT);
+	x2->allocate_by_size(64, YAMM_FIRST_FIT);
+	my_memory.soft_reset();
+
+	yamm_statistics top = my_memory.get_level_statistics(0);
+	std::cout << "After a soft reset: " << my_memory.get_number_of_levels()
+			<< " level(s), " << top.number_of_buffers << " used, "
+			<< top.number_of_free_buffers << " free\n";
+
+	if ((my_memory.get_number_of_levels() != 1) || (top.number_of_buffers != 0)
+			|| (top.number_of_free_buffers != 1)
+			|| (!my_memory.check_address_space_consistency())) {
+		std::cout << "\n\n\nStatistics FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// The largest free buffer starts too far from a 4K boundary, a smaller but
+	// aligned one holds the largest aligned allocation
+	yamm aligned_memory;
+	aligned_memory.build(16 * 1024);
+	aligned_memory.insert(new yamm_buffer(0x0, 0x100));
+	aligned_memory.insert(new yamm_buffer(0x1100, 0xf00));
+	aligned_memory.insert(new yamm_buffer(0x2800, 0x1800));
+
+	uint_64_t unaligned = aligned_memory.largest_allocatable(1, 1);
+	uint_64_t aligned = aligned_memory.largest_allocatable(4 * 1024, 1);
+	uint_64_t granular = aligned_memory.largest_allocatable(4 * 1024, 0x300);
+
+	std::cout << "\nExpected 0x1000 0x800 0x600 \tFound:0x" << std::hex
+			<< unaligned << " 0x" << aligned << " 0x" << granular << std::dec
+			<< "\n";
+
+	if ((unaligned != 0x1000) || (aligned != 0x800) || (granular != 0x600)) {
+		std::cout << "\n\n\nLargest allocatable FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// The size found is allocated with the same alignment, one more byte isn't.
+	// Then only the end of the badly aligned free buffer is left.
+	yamm_buffer* too_big = new yamm_buffer(aligned + 1);
+	too_big->set_start_addr_alignment(4 * 1024);
+	yamm_buffer* largest = new yamm_buffer(aligned);
+	largest->set_start_addr_alignment(4 * 1024);
+
+	if ((aligned_memory.allocate(too_big, YAMM_BEST_FIT))
+			|| (!aligned_memory.allocate(largest, YAMM_BEST_FIT))
+			|| (largest->get_start_addr() != 0x2000)
+			|| (aligned_memory.largest_allocatable(4 * 1024, 1) != 0x100)
+			|| (!aligned_memory.check_address_space_consistency())) {
+		std::cout << "\n\n\nLargest allocatable FAIL!\n\n\n";
+		exit(YAMM_EXIT_CODE);
+	}
+
+	std::cout << "Aligned allocation of the largest size at 0x" << std::hex
+			<< largest->get_start_addr() << std::dec << "\n";
+	delete too_big;
+
+	return 0;
+
+}
+
+#endif // __yamm_statistics_test
@@ -36,6 +36,10 @@ namespace yamm_ns {
 #define YAMM_FIRST_FIT 3
 #define YAMM_BEST_FIT 4
 #define YAMM_UNIFORM_FIT 5
+#define YAMM_BUDDY_FIT 6
+#define YAMM_TLSF_FIT 7
+#define YAMM_NEXT_FIT 8
+#define YAMM_RANDOM_ADDR_FIT 9
 
 #define YAMM_EXIT_CODE 19420
 
@@ -24,19 +24,31 @@ namespace yamm_ns {
 typedef unsigned long long int uint_64_t;
 #endif
 
+#ifndef uint_32_t
+typedef unsigned int uint_32_t;
+#endif
+
+#ifdef __SIZEOF_INT128__
+/** Address type for memories of 2^64 bytes and more */
+typedef unsigned __int128 uint_128_t;
+#endif
+
 /**
  * Class that models a basic access which requires a start address and a size
  * End address is computed automatically
+ *
+ * AddrT is the address type, yamm_access uses 64-bit addresses
  */
-class yamm_access {
+template<class AddrT>
+class yamm_basic_access {
 public:
 
 	/** Start address of the access. Given by user */
-	uint_64_t start_addr;
+	AddrT start_addr;
 	/** End address of the access. Computed automatically  */
-	uint_64_t end_addr;
+	AddrT end_addr;
 	/** Size of the access. Given by user */
-	uint_64_t size;
+	AddrT size;
 
 	/**
 	 *	Access constructor.
@@ -45,7 +57,7 @@ public:
 	 *	@param start_addr start address of the access
 	 *	@param size Size of the access
 	 */
-	yamm_access(uint_64_t start_addr, uint_64_t size) {
+	yamm_basic_access(AddrT start_addr, AddrT size) {
 		this->start_addr = start_addr;
 		this->size = size;
 		this->end_addr = this->compute_end_addr();
@@ -56,11 +68,17 @@ protected:
 	 * 	Function that computes the end address of the access
 	 * 	@return the access' end address
 	 */
-	uint_64_t compute_end_addr() {
+	AddrT compute_end_addr() {
 		return this->start_addr + this->size - 1;
 	}
 
 };
 
+typedef yamm_basic_access<uint_64_t> yamm_access;
+typedef yamm_basic_access<uint_32_t> yamm_access_32;
+#ifdef __SIZEOF_INT128__
+typedef yamm_basic_access<uint_128_t> yamm_access_128;
+#endif
+
 }
 #endif // __yamm_access_h
@@ -19,11 +19,12 @@
 #define __yamm_allocate
 
 #include "yamm.h"
+#include <algorithm>
 
 using namespace yamm_ns;
 
-// Function allocates buffer n according to allocation_mode
-bool yamm_buffer::allocate(yamm_buffer* new_buffer, int allocation_mode) {
+// Function checks that new_buffer can be allocated inside this buffer
+bool yamm_buffer::check_new_buffer(yamm_buffer* new_buffer) {
 
 	if (size == 0) {
 		fprintf(stderr,
@@ -66,13 +67,53 @@ bool yamm_buffer::allocate(yamm_buffer* new_buffer, int allocation_mode) {
 		return 0;
 	}
 
+	return 1;
+}
+
+// Function allocates buffer n according to allocation_mode
+bool yamm_buffer::allocate(yamm_buffer* new_buffer, int allocation_mode) {
+
+	YAMM_COUNT_MODE(lookups, allocation_mode);
+
+	if (!place(new_buffer, allocation_mode)) {
+		YAMM_COUNT_MODE(failed_lookups, allocation_mode);
+		return 0;
+	}
+
+	notify(YAMM_EVENT_ALLOCATE, new_buffer, allocation_mode, 0, 0);
+	return 1;
+}
+
+bool yamm_buffer::place(yamm_buffer* new_buffer, int allocation_mode) {
+
+	if (!check_new_buffer(new_buffer))
+		return 0;
+
 	// Compute size with granularity
-	new_buffer->size = new_buffer->size
-			+ (new_buffer->granularity - new_buffer->size % new_buffer->granularity) % new_buffer->granularity;
+	new_buffer->size = compute_size_with_gran(new_buffer->size,
+			new_buffer->granularity, new_buffer->granularity_mask);
+
+	// A slab only has to find a free slot
+	if (is_slab())
+		return allocate_slot(new_buffer, allocation_mode, 0,
+				container_state->slab_number_of_slots - 1);
+
+	// Buddy allocation has its own free lists
+	if (allocation_mode == YAMM_BUDDY_FIT)
+		return allocate_buddy(new_buffer);
+
+	// TLSF allocation has its own size classes
+	if (allocation_mode == YAMM_TLSF_FIT)
+		return allocate_tlsf(new_buffer);
+
+	// Uniform start addresses are sampled from the free space tree
+	if (allocation_mode == YAMM_RANDOM_ADDR_FIT)
+		return allocate_random_addr(new_buffer);
 
 	// Find a free buffer that can contain the allocated buffer and matches the selected allocation_mode
 	yamm_buffer* temp_free = find_suitable_buffer(new_buffer->size,
-			new_buffer->start_addr_alignment, allocation_mode);
+			new_buffer->start_addr_alignment,
+			new_buffer->start_addr_alignment_mask, allocation_mode);
 
 	if (!temp_free) {
 		return 0;
@@ -84,6 +125,12 @@ bool yamm_buffer::allocate(yamm_buffer* new_buffer, int allocation_mode) {
 		return 0;
 
 	new_buffer->end_addr = new_buffer->start_addr + new_buffer->size - 1;
+
+	// The next search starts with what remains of the free buffer, add() moves
+	// the pointer to the following free buffer if nothing remains
+	if (allocation_mode == YAMM_NEXT_FIT)
+		container_state->next_fit_rover = temp_free;
+
 	add(new_buffer, temp_free);
 	return 1;
 
@@ -104,4 +151,375 @@ yamm_buffer* yamm_buffer::allocate_by_size(uint_64_t size,
 	return NULL;
 }
 
+uint_64_t yamm_buffer::get_largest_satisfiable_size(int allocation_mode) {
+
+	uint_64_t largest = get_largest_free_extent();
+
+	// A slab only looks for a free slot, whatever the mode
+	if ((largest == 0) || (is_slab()))
+		return largest;
+
+	// The largest free block, the requests are rounded up to a power of two
+	if (allocation_mode == YAMM_BUDDY_FIT) {
+		init_buddy_blocks();
+		uint_64_t orders = container_state->buddy_orders;
+		return orders ? 1ull << (63 - __builtin_clzll(orders)) : 0;
+	}
+
+	// The requests are rounded up to the next size class, so only the lower bound
+	// of the class of the largest free buffer is sure to be found
+	if ((allocation_mode == YAMM_TLSF_FIT) && (largest >= YAMM_TLSF_SL_COUNT))
+		return largest
+				& ~((1ull << (63 - __builtin_clzll(largest) - YAMM_TLSF_SL_BITS))
+						- 1);
+
+	return largest;
+}
+
+// Function allocates buffers with sizes drawn from size_distribution until target_usage is reached
+std::vector<yamm_buffer*> yamm_buffer::populate(double target_usage,
+		yamm_size_distribution &size_distribution, int allocation_mode) {
+
+	std::vector<yamm_buffer*> result;
+
+	if ((target_usage < 0) || (target_usage > 100)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Target usage %f is not a percentage!\n\t in %s at line %d\n",
+					target_usage, __FILE__, __LINE__);
+		return result;
+	}
+
+	uint_64_t target_bytes = (uint_64_t) ((long double) size * target_usage / 100);
+
+	// A slab has its slots, buddy and TLSF allocation have their own free lists
+	if ((is_slab()) || (allocation_mode == YAMM_BUDDY_FIT)
+			|| (allocation_mode == YAMM_TLSF_FIT))
+		return populate_by_size(target_bytes, size_distribution,
+				allocation_mode);
+
+	init_free_buffer();
+
+	// The free space is copied once from the indexes and the requests are planned
+	// against the copy: start address -> end address, and (size, start address)
+	std::map<uint_64_t, uint_64_t> free_ends;
+	std::set<std::pair<uint_64_t, uint_64_t> > free_sizes;
+
+	for (std::map<uint_64_t, yamm_buffer*>::iterator it =
+			container_state->free_by_addr.begin();
+			it != container_state->free_by_addr.end(); ++it)
+		free_ends[it->first] = it->second->end_addr;
+
+	for (std::map<std::pair<uint_64_t, uint_64_t>, yamm_buffer*>::iterator it =
+			container_state->free_by_size.begin();
+			it != container_state->free_by_size.end(); ++it)
+		free_sizes.insert(it->first);
+
+	// (start address, size) of each request
+	std::vector<std::pair<uint_64_t, uint_64_t> > planned;
+	uint_64_t used_bytes = get_used_bytes();
+	uint_64_t rover =
+			container_state->next_fit_rover ?
+					container_state->next_fit_rover->start_addr : start_addr;
+
+	while ((used_bytes < target_bytes) && (!free_sizes.empty())) {
+
+		uint_64_t new_size = size_distribution.next_size();
+		if (new_size == 0)
+			new_size = 1;
+
+		// Don't go over the target and don't ask for more than the largest free buffer
+		if (new_size > target_bytes - used_bytes)
+			new_size = target_bytes - used_bytes;
+		if (new_size > free_sizes.rbegin()->first)
+			new_size = free_sizes.rbegin()->first;
+
+		YAMM_COUNT_MODE(lookups, allocation_mode);
+		planned.push_back(
+				std::make_pair(
+						plan_request(free_ends, free_sizes, new_size,
+								allocation_mode, rover), new_size));
+		used_bytes += new_size;
+	}
+
+	if (planned.empty())
+		return result;
+
+	// Next fit resumes after the last request planned, not the last one placed
+	uint_64_t last_planned = planned.back().first;
+
+	std::sort(planned.begin(), planned.end());
+
+	// One walk over the free buffers in address order, each request is placed in the
+	// free buffer that contains it and the search for the next one starts there
+	yamm_buffer* temp = first_free;
+
+	for (uint_64_t i = 0; i < planned.size(); ++i) {
+
+		while (temp->end_addr < planned[i].first)
+			temp = temp->next_free;
+
+		yamm_buffer* new_buffer = new yamm_buffer(planned[i].first,
+				planned[i].second);
+
+		// add() keeps the free buffer for what remains after the new one
+		bool remains = (new_buffer->end_addr < temp->end_addr);
+		yamm_buffer* next_free_buffer = temp->next_free;
+
+		if ((allocation_mode == YAMM_NEXT_FIT)
+				&& (planned[i].first == last_planned))
+			container_state->next_fit_rover = temp;
+
+		add(new_buffer, temp);
+		notify(YAMM_EVENT_ALLOCATE, new_buffer, allocation_mode, 0, 0);
+		result.push_back(new_buffer);
+
+		if (!remains)
+			temp = next_free_buffer;
+	}
+
+	return result;
+}
+
+std::vector<yamm_buffer*> yamm_buffer::populate_by_size(uint_64_t target_bytes,
+		yamm_size_distribution &size_distribution, int allocation_mode) {
+
+	std::vector<yamm_buffer*> result;
+
+	while (get_used_bytes() < target_bytes) {
+
+		uint_64_t largest = get_largest_satisfiable_size(allocation_mode);
+		if (largest == 0)
+			break;
+
+		uint_64_t new_size = size_distribution.next_size();
+		if (new_size == 0)
+			new_size = 1;
+
+		// Don't go over the target and don't ask for more than the mode can allocate
+		if (new_size > target_bytes - get_used_bytes())
+			new_size = target_bytes - get_used_bytes();
+		if (new_size > largest)
+			new_size = largest;
+
+		yamm_buffer* new_buffer = allocate_by_size(new_size, allocation_mode);
+		if (!new_buffer)
+			break;
+
+		result.push_back(new_buffer);
+	}
+
+	return result;
+}
+
+uint_64_t yamm_buffer::plan_request(std::map<uint_64_t, uint_64_t> &free_ends,
+		std::set<std::pair<uint_64_t, uint_64_t> > &free_sizes,
+		uint_64_t size, int allocation_mode, uint_64_t &rover) {
+
+	std::map<uint_64_t, uint_64_t>::iterator chosen;
+	std::set<std::pair<uint_64_t, uint_64_t> >::iterator fit =
+			free_sizes.lower_bound(std::make_pair(size, 0));
+	uint_64_t new_start_addr = 0;
+
+	switch (allocation_mode) {
+	case YAMM_BEST_FIT:
+	case YAMM_BEST_FIT_RND:
+		chosen = free_ends.find(fit->second);
+		break;
+
+	case YAMM_UNIFORM_FIT:
+		chosen = free_ends.find(free_sizes.rbegin()->second);
+		break;
+
+	case YAMM_RANDOM_FIT: {
+		// Each free buffer that fits is equally likely
+		uint_64_t number_of_fits = std::distance(fit, free_sizes.end());
+		std::advance(fit, generate_rand64() % number_of_fits);
+		chosen = free_ends.find(fit->second);
+		break;
+	}
+
+	case YAMM_RANDOM_ADDR_FIT: {
+		// Each start address where the buffer fits is equally likely
+		uint_64_t number_of_addrs = 0;
+		for (std::set<std::pair<uint_64_t, uint_64_t> >::iterator it = fit;
+				it != free_sizes.end(); ++it)
+			number_of_addrs += it->first - size + 1;
+
+		uint_64_t target = generate_rand64() % number_of_addrs;
+		while (target > fit->first - size) {
+			target -= fit->first - size + 1;
+			++fit;
+		}
+
+		chosen = free_ends.find(fit->second);
+		new_start_addr = fit->second + target;
+		break;
+	}
+
+	case YAMM_NEXT_FIT:
+		// Resume from where the last request ended and wrap around once
+		chosen = free_ends.lower_bound(rover);
+		for (uint_64_t i = 0; i <= free_ends.size(); ++i, ++chosen) {
+			if (chosen == free_ends.end())
+				chosen = free_ends.begin();
+			if (size - 1 <= chosen->second - chosen->first)
+				break;
+		}
+		break;
+
+	default:
+		chosen = free_ends.begin();
+		while (size - 1 > chosen->second - chosen->first)
+			++chosen;
+		break;
+	}
+
+	uint_64_t free_start_addr = chosen->first;
+	uint_64_t free_end_addr = chosen->second;
+
+	// Number of start addresses after the first one where the buffer still fits
+	uint_64_t slots = free_end_addr - free_start_addr - (size - 1);
+
+	switch (allocation_mode) {
+	case YAMM_RANDOM_FIT ... YAMM_BEST_FIT_RND:
+		new_start_addr = free_start_addr;
+		if (slots)
+			new_start_addr += generate_rand64() % (slots + 1);
+		break;
+	case YAMM_UNIFORM_FIT:
+		new_start_addr = free_start_addr + slots / 2;
+		break;
+	case YAMM_RANDOM_ADDR_FIT:
+		break;
+	default:
+		new_start_addr = free_start_addr;
+		break;
+	}
+
+	uint_64_t new_end_addr = new_start_addr + size - 1;
+
+	// The request splits the free buffer in what is left before and after it
+	free_sizes.erase(
+			std::make_pair(free_end_addr - free_start_addr + 1,
+					free_start_addr));
+	free_ends.erase(chosen);
+
+	if (new_start_addr > free_start_addr) {
+		free_ends[free_start_addr] = new_start_addr - 1;
+		free_sizes.insert(
+				std::make_pair(new_start_addr - free_start_addr,
+						free_start_addr));
+	}
+
+	if (new_end_addr < free_end_addr) {
+		free_ends[new_end_addr + 1] = free_end_addr;
+		free_sizes.insert(
+				std::make_pair(free_end_addr - new_end_addr, new_end_addr + 1));
+	}
+
+	rover = new_end_addr + 1;
+	return new_start_addr;
+}
+
+// Function allocates buffer n according to allocation_mode inside the window [lo, hi]
+bool yamm_buffer::allocate_in_range(yamm_buffer* new_buffer,
+		int allocation_mode, uint_64_t lo, uint_64_t hi) {
+
+	YAMM_COUNT_MODE(lookups, allocation_mode);
+
+	if (!place_in_range(new_buffer, allocation_mode, lo, hi)) {
+		YAMM_COUNT_MODE(failed_lookups, allocation_mode);
+		return 0;
+	}
+
+	notify(YAMM_EVENT_ALLOCATE, new_buffer, allocation_mode, 0, 0);
+	return 1;
+}
+
+bool yamm_buffer::place_in_range(yamm_buffer* new_buffer, int allocation_mode,
+		uint_64_t lo, uint_64_t hi) {
+
+	if (!check_new_buffer(new_buffer))
+		return 0;
+
+	if (((allocation_mode == YAMM_BUDDY_FIT)
+			|| (allocation_mode == YAMM_TLSF_FIT)) && (!is_slab())) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] YAMM_BUDDY_FIT and YAMM_TLSF_FIT can't be used in a window!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	if ((lo > hi) || (hi < start_addr) || (lo > end_addr)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Window [%llx, %llx] is not in memory!\n\t in %s at line %d\n",
+					lo, hi, __FILE__, __LINE__);
+		return 0;
+	}
+
+	// Compute size with granularity
+	new_buffer->size = compute_size_with_gran(new_buffer->size,
+			new_buffer->granularity, new_buffer->granularity_mask);
+
+	// A slab uses the slots that are entirely inside the window
+	if (is_slab()) {
+		uint_64_t first_slot = 0;
+		if (lo > start_addr)
+			first_slot = (lo - start_addr + container_state->slab_slot_size - 1)
+					/ container_state->slab_slot_size;
+
+		uint_64_t last_slot = container_state->slab_number_of_slots - 1;
+		if (hi < end_addr) {
+			uint_64_t slots_below = (hi - start_addr + 1) / container_state->slab_slot_size;
+			if (slots_below == 0)
+				return 0;
+			if (slots_below <= last_slot)
+				last_slot = slots_below - 1;
+		}
+
+		if (first_slot >= container_state->slab_number_of_slots)
+			return 0;
+
+		return allocate_slot(new_buffer, allocation_mode, first_slot, last_slot);
+	}
+
+	// Find a free buffer that intersects the window and the start address inside it
+	uint_64_t new_start_addr;
+	yamm_buffer* temp_free = find_suitable_buffer_in_range(new_buffer->size,
+			new_buffer->start_addr_alignment,
+			new_buffer->start_addr_alignment_mask, allocation_mode, lo, hi,
+			new_start_addr);
+
+	if (!temp_free)
+		return 0;
+
+	new_buffer->start_addr = new_start_addr;
+	new_buffer->end_addr = new_buffer->start_addr + new_buffer->size - 1;
+
+	// Same as allocate(), add() keeps the free buffer for what remains after the
+	// new one or moves the pointer to the following free buffer
+	if (allocation_mode == YAMM_NEXT_FIT)
+		container_state->next_fit_rover = temp_free;
+
+	add(new_buffer, temp_free);
+	return 1;
+}
+
+// Function creates a new buffer with the specified size and then calls allocate_in_range for that buffer
+yamm_buffer* yamm_buffer::allocate_by_size_in_range(uint_64_t size,
+		int allocation_mode, uint_64_t lo, uint_64_t hi) {
+
+	yamm_buffer* n = new yamm_buffer(size);
+
+	if (allocate_in_range(n, allocation_mode, lo, hi))
+		return n;
+
+	// Allocation failed so we clean up and return a NULL handle
+	delete n;
+	return NULL;
+}
+
 #endif // __yamm_allocate
@@ -0,0 +1,118 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_buddy
+#define __yamm_buddy
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+// The buddy blocks are derived from the free buffers: each free buffer is split into the
+// largest naturally aligned power of two blocks it contains. A free block and its buddy
+// can only both be free if they are part of the same free buffer, where merge() already
+// joined them, so the block lists are always fully coalesced.
+
+void yamm_buffer::update_buddy_blocks(yamm_buffer* free_buffer, bool add) {
+
+	uint_64_t addr = free_buffer->start_addr;
+
+	while (1) {
+
+		// Largest order that fits in what is left of the free buffer
+		uint_64_t remaining = free_buffer->end_addr - addr;
+		uint order = (remaining + 1) ? 63 - __builtin_clzll(remaining + 1) : 63;
+
+		// and that addr is aligned to
+		if ((addr) && ((uint) __builtin_ctzll(addr) < order))
+			order = __builtin_ctzll(addr);
+
+		if (add) {
+			container_state->buddy_blocks[order].insert(addr);
+			container_state->buddy_orders |= (1ull << order);
+		} else {
+			container_state->buddy_blocks[order].erase(addr);
+			if (container_state->buddy_blocks[order].empty())
+				container_state->buddy_orders &= ~(1ull << order);
+		}
+
+		uint_64_t block_end = addr + ((1ull << order) - 1);
+		if (block_end == free_buffer->end_addr)
+			break;
+
+		addr = block_end + 1;
+	}
+}
+
+void yamm_buffer::init_buddy_blocks() {
+
+	init_free_buffer();
+
+	// The first buddy allocation builds the block lists, after that they are kept
+	// up to date by index_free_buffer() and unindex_free_buffer()
+	if (container_state->buddy_blocks.empty()) {
+		container_state->buddy_blocks.resize(64);
+		for (std::map<uint_64_t, yamm_buffer*>::iterator it =
+				container_state->free_by_addr.begin();
+				it != container_state->free_by_addr.end(); ++it)
+			update_buddy_blocks(it->second, 1);
+	}
+}
+
+bool yamm_buffer::allocate_buddy(yamm_buffer* new_buffer) {
+
+	if ((new_buffer->start_addr_alignment_mask == YAMM_NO_MASK)
+			|| (new_buffer->granularity_mask == YAMM_NO_MASK)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] YAMM_BUDDY_FIT needs power of two alignment and granularity!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	// The block has to hold the buffer and to respect its alignment
+	uint_64_t block_size =
+			(new_buffer->size > new_buffer->start_addr_alignment) ?
+					new_buffer->size : new_buffer->start_addr_alignment;
+
+	if (block_size > (1ull << 63))
+		return 0;
+
+	uint order = (block_size == 1) ? 0 : 64 - __builtin_clzll(block_size - 1);
+
+	init_buddy_blocks();
+
+	// Smallest order with a free block that is large enough
+	uint_64_t orders = container_state->buddy_orders & (~0ull << order);
+	if (!orders)
+		return 0;
+
+	uint_64_t block_start = *container_state->buddy_blocks[__builtin_ctzll(orders)].begin();
+
+	// The free buffer that contains the block
+	std::map<uint_64_t, yamm_buffer*>::iterator it =
+			container_state->free_by_addr.upper_bound(block_start);
+	--it;
+
+	new_buffer->size = 1ull << order;
+	new_buffer->start_addr = block_start;
+	new_buffer->end_addr = new_buffer->start_addr + new_buffer->size - 1;
+	add(new_buffer, it->second);
+	return 1;
+}
+
+#endif // __yamm_buddy
@@ -19,7 +19,17 @@
 #define __yamm_buffer_h
 
 #include "yamm_access.h"
+#include "yamm_diff.h"
+#include "yamm_observer.h"
+#include "yamm_perf_counters.h"
+#include "yamm_size_distribution.h"
+#include "yamm_statistics.h"
+#include "yamm_violation.h"
 #include <vector>
+#include <map>
+#include <set>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
 
 namespace yamm_ns {
 
@@ -27,12 +37,162 @@ namespace yamm_ns {
 typedef unsigned int uint_32_t;
 #endif
 
+/** Mask of alignments and granularities that aren't a power of two */
+#define YAMM_NO_MASK 0xFFFFFFFFFFFFFFFFull
+
+/** log2 of the number of TLSF second level classes */
+#define YAMM_TLSF_SL_BITS 5
+/** Number of TLSF second level classes per first level */
+#define YAMM_TLSF_SL_COUNT (1 << YAMM_TLSF_SL_BITS)
+/** Number of TLSF first levels */
+#define YAMM_TLSF_FL_COUNT (64 - YAMM_TLSF_SL_BITS + 1)
+
+/** Slot index used for "no slot" */
+#define YAMM_NO_SLOT 0xFFFFFFFFFFFFFFFFull
+
+class yamm_buffer;
+
+/**
+ * Node update of yamm_free_space_tree: each node holds the total size and the
+ * number of the free buffers in its subtree
+ */
+template<class Node_CItr, class Node_Itr, class Cmp_Fn, class _Alloc>
+class yamm_free_space_update {
+public:
+
+	/** (total size, number of free buffers) */
+	typedef std::pair<uint_64_t, uint_64_t> metadata_type;
+
+	void operator()(Node_Itr node, Node_CItr end_node) {
+
+		Node_Itr left = node.get_l_child();
+		Node_Itr right = node.get_r_child();
+
+		metadata_type sum((*node)->first.first, 1);
+
+		if (left != end_node) {
+			sum.first += left.get_metadata().first;
+			sum.second += left.get_metadata().second;
+		}
+
+		if (right != end_node) {
+			sum.first += right.get_metadata().first;
+			sum.second += right.get_metadata().second;
+		}
+
+		const_cast<metadata_type&>(node.get_metadata()) = sum;
+	}
+
+	virtual Node_CItr node_begin() const = 0;
+	virtual Node_CItr node_end() const = 0;
+
+	virtual ~yamm_free_space_update() {
+	}
+};
+
+/** Free buffers ordered by size and start address, with the sums of their subtrees */
+typedef __gnu_pbds::tree<std::pair<uint_64_t, uint_64_t>, yamm_buffer*,
+		std::less<std::pair<uint_64_t, uint_64_t> >, __gnu_pbds::rb_tree_tag,
+		yamm_free_space_update> yamm_free_space_tree;
+
+/**
+ * Receives the buffers moved by yamm_buffer::compact(), e.g. to retarget the DMA
+ * pointers of the testbench
+ */
+class yamm_relocation_listener {
+public:
+
+	/**
+	 * Called after a buffer is moved, it keeps its contents and its size
+	 *
+	 * @param buffer The buffer moved, get_start_addr() is the new address
+	 * @param old_start_addr The start address before the move
+	 */
+	virtual void buffer_moved(yamm_buffer* buffer, uint_64_t old_start_addr) = 0;
+
+	virtual ~yamm_relocation_listener() {
+	}
+};
+
+/**
+ * State of a buffer that contains a memory map or is a slab: its counters, the
+ * indexes of its free buffers and its slots. It's only allocated when something is
+ * placed inside the buffer, when it becomes a slab or when it gets an observer,
+ * so the free buffers and the occupied buffers with nothing inside don't carry it.
+ */
+class yamm_container_state {
+public:
+
+	/** total size of the free buffers contained */
+	uint_64_t free_bytes;
+	/** free buffers contained, ordered by size and start address */
+	std::map<std::pair<uint_64_t, uint_64_t>, yamm_buffer*> free_by_size;
+	/** free buffers contained, ordered by start address */
+	std::map<uint_64_t, yamm_buffer*> free_by_addr;
+	/** number of free buffers contained for each log2 size class, allocated on
+	 * first use */
+	std::vector<uint> free_histogram;
+	/** statistics of the memory maps contained, entry i is for recursion level i
+	 * below this buffer */
+	std::vector<yamm_statistics> level_statistics;
+	/** free buffer contained where the next YAMM_NEXT_FIT search starts, NULL to start
+	 * with first_free. Moved by link_in_list() and merge() when they delete it */
+	yamm_buffer* next_fit_rover;
+	/** Told about the changes of this memory map and of the ones nested in it */
+	yamm_observer* observer;
+
+	/** start addresses of the free power of two blocks contained, per order (log2 of
+	 * the block size). Built on the first YAMM_BUDDY_FIT allocation inside this buffer */
+	std::vector<std::set<uint_64_t> > buddy_blocks;
+	/** bit k is set if buddy_blocks[k] isn't empty */
+	uint_64_t buddy_orders;
+	/** heads of the TLSF free lists, YAMM_TLSF_SL_COUNT classes per first level.
+	 * Built on the first YAMM_TLSF_FIT allocation inside this buffer */
+	std::vector<yamm_buffer*> tlsf_heads;
+	/** bit fl is set if tlsf_sl_bitmaps[fl] isn't 0 */
+	uint_64_t tlsf_fl_bitmap;
+	/** bit sl of entry fl is set if the list of class (fl, sl) isn't empty */
+	std::vector<uint_32_t> tlsf_sl_bitmaps;
+	/** free buffers contained, ordered by size, with subtree sums used to sample start
+	 * addresses. Built on the first YAMM_RANDOM_ADDR_FIT allocation inside this buffer */
+	yamm_free_space_tree* free_space_tree;
+
+	/** size of the slots if this buffer is a slab, 0 otherwise */
+	uint_64_t slab_slot_size;
+	/** number of slots of the slab, the bytes after the last slot aren't used */
+	uint_64_t slab_number_of_slots;
+	/** bit i of word i / 64 is set if slot i of the slab is occupied */
+	std::vector<uint_64_t> slab_bitmap;
+	/** the occupied buffer of each slot of the slab, NULL for free slots */
+	std::vector<yamm_buffer*> slab_slots;
+	/** all the bitmap words before this one are full */
+	uint_64_t slab_hint;
+
+	yamm_container_state() {
+		free_bytes = 0;
+		next_fit_rover = NULL;
+		observer = NULL;
+		buddy_orders = 0;
+		tlsf_fl_bitmap = 0;
+		free_space_tree = NULL;
+		slab_slot_size = 0;
+		slab_number_of_slots = 0;
+		slab_hint = 0;
+	}
+
+	~yamm_container_state() {
+		delete free_space_tree;
+	}
+
+};
+
 /**
  *  Class that defines a buffer
  */
 class yamm_buffer {
 private:
 	friend class yamm;
+	friend class yamm_consistency_checker;
 protected:
 
 	// Top buffer pointers (container level)
@@ -41,6 +201,22 @@ protected:
 	yamm_buffer* first_free;
 	/**  first buffer contained (free or occupied) */
 	yamm_buffer* first;
+	/**  number of occupied buffers */
+	uint number_of_buffers;
+	/** number of free buffers */
+	uint number_of_free_buffers;
+	/** indexes and counters of the buffers contained, NULL until something is
+	 * placed inside */
+	yamm_container_state* container_state;
+
+	/** Number of buffers with an observer, the events are only built if it isn't 0 */
+	static uint number_of_observers;
+
+	/** Work done by all the memory maps, updated if YAMM_PERF_COUNTERS is defined */
+	static yamm_perf_counters perf_counters;
+
+	/** buffer that contains this one, NULL for the top level */
+	yamm_buffer* parent;
 
 	// Links in the list (current level)
 
@@ -48,6 +224,10 @@ protected:
 	yamm_buffer* next_free;
 	/** previous free buffer on current recursion level */
 	yamm_buffer* prev_free;
+	/** next free buffer in the same TLSF size class */
+	yamm_buffer* tlsf_next;
+	/** previous free buffer in the same TLSF size class */
+	yamm_buffer* tlsf_prev;
 	/**  next buffer on current recursion level (free or occupied) */
 	yamm_buffer* next;
 	/**  previous free buffer on current recursion level (free or occupied) */
@@ -55,10 +235,6 @@ protected:
 
 	/** buffer's payload */
 	char* contents;
-	/**  number of occupied buffers */
-	uint number_of_buffers;
-	/** number of free buffers */
-	uint number_of_free_buffers;
 
 	/** Start address of the buffer */
 	uint_64_t start_addr;
@@ -68,47 +244,77 @@ protected:
 	uint_64_t size;
 
 	/** Granularity of the buffer */
-	uint_32_t granularity;
+	uint_64_t granularity;
 	/** Alignment of the buffer */
-	uint_32_t start_addr_alignment;
+	uint_64_t start_addr_alignment;
+	/** granularity - 1 if the granularity is a power of two, YAMM_NO_MASK otherwise */
+	uint_64_t granularity_mask;
+	/** start_addr_alignment - 1 if the alignment is a power of two, YAMM_NO_MASK otherwise */
+	uint_64_t start_addr_alignment_mask;
 
 	/** Buffer is not occupied */
 	bool is_free;
 	/** Buffer is allocated in static mode */
 	bool is_static;
+	/** Buffer was placed by insert(), the user chose its address */
+	bool is_inserted;
 
 	/** Name given by user */
 	std::string name;
 
+	/**
+	 * Returns the state of this buffer as a container, it's allocated on the first call
+	 * Used by index_free_buffer(), update_statistics(), make_slab() and set_observer()
+	 */
+	yamm_container_state* get_container_state() {
+		if (!container_state)
+			container_state = new yamm_container_state();
+		return container_state;
+	}
+
 	/**
 	 *  Generates a random unsigned int64
 	 *  @return random unsigned int64
 	 */
 	uint_64_t generate_rand64();
 
+	/**
+	 * Computes the mask used instead of % for power of two alignments and granularities
+	 * Used by the setters and constructors
+	 *
+	 * @param value The alignment or granularity
+	 *
+	 * @return value - 1 if value is a power of two, YAMM_NO_MASK otherwise
+	 */
+	static uint_64_t compute_mask(uint_64_t value) {
+		return (value && !(value & (value - 1))) ? value - 1 : YAMM_NO_MASK;
+	}
+
 	/**
 	 * Used to compute start_addr with alignment, only works for positive increment
 	 * Used by allocate() and insert()
 	 *
 	 * @param alignment The alignment needed
+	 * @param alignment_mask The mask of the alignment, computed by compute_mask()
 	 * @param free_buffer Free buffer in which the allocation takes place, used for boundaries checking
 	 *
 	 * @return Aligned start_addr if boundaries checking passes or temp buffer's (end_addr+1) if not
 	 */
-	uint_64_t get_aligned_addr(const uint_32_t &alignment,
+	uint_64_t get_aligned_addr(uint_64_t alignment, uint_64_t alignment_mask,
 			yamm_buffer* free_buffer);
 
 	/**
 	 * Computes the size taking in account alignment using get_aligned_addr()
 	 * Used by find_suitable_buffer()
 	 *
-	 * @param alignment  The regular size of the buffer
-	 * @param temp The granularity of the buffer
+	 * @param alignment The alignment needed
+	 * @param alignment_mask The mask of the alignment, computed by compute_mask()
+	 * @param temp The free buffer
 	 *
-	 * @return The new size taking in account the granularity
+	 * @return The size available in temp after the first aligned address
 	 */
-	uint_64_t compute_size_with_align(const uint_32_t &alignment,
-			yamm_buffer* temp);
+	uint_64_t compute_size_with_align(uint_64_t alignment,
+			uint_64_t alignment_mask, yamm_buffer* temp);
 
 	/**
 	 * Computes and returns the size of the buffer on which it is called
@@ -116,10 +322,12 @@ protected:
 	 *
 	 * @param size The regular size of the buffer
 	 * @param granularity The granularity of the buffer
+	 * @param granularity_mask The mask of the granularity, computed by compute_mask()
 	 *
 	 * @return The new size taking in account the granularity
 	 */
-	uint_64_t compute_size_with_gran(uint_64_t size, uint_32_t granularity);
+	uint_64_t compute_size_with_gran(uint_64_t size, uint_64_t granularity,
+			uint_64_t granularity_mask);
 
 	/**
 	 * It computes and updates start_addr for various allocation modes, uses get_aligned_addr() and get_closest_aligned_addr()
@@ -159,6 +367,317 @@ protected:
 	void link_in_list(yamm_buffer* temp_prev, yamm_buffer* n,
 			yamm_buffer* temp);
 
+	/**
+	 * Adds a free buffer to the free space statistics of this buffer
+	 * Used by add() and deallocate() after a free buffer was created or resized
+	 *
+	 * @param free_buffer The contained free buffer
+	 */
+	void index_free_buffer(yamm_buffer* free_buffer);
+
+	/**
+	 * Removes a free buffer from the free space statistics of this buffer
+	 * Used by add() and merge() before a free buffer is resized or deleted
+	 *
+	 * @param free_buffer The contained free buffer
+	 */
+	void unindex_free_buffer(yamm_buffer* free_buffer);
+
+	/**
+	 * Splits a free buffer into the largest naturally aligned power of two blocks
+	 * and adds them to (or removes them from) buddy_blocks
+	 * Used by index_free_buffer(), unindex_free_buffer() and init_buddy_blocks()
+	 *
+	 * @param free_buffer The contained free buffer
+	 * @param add If set to 1 the blocks are added, otherwise they are removed
+	 */
+	void update_buddy_blocks(yamm_buffer* free_buffer, bool add);
+
+	/**
+	 * Builds buddy_blocks from the free buffers if it wasn't built yet, after that
+	 * it is kept up to date by index_free_buffer() and unindex_free_buffer()
+	 * Used by allocate_buddy() and get_largest_satisfiable_size()
+	 */
+	void init_buddy_blocks();
+
+	/**
+	 * Allocates new_buffer in YAMM_BUDDY_FIT mode: its size is rounded up to a power
+	 * of two block, at least as large as its alignment, and it takes the lowest free
+	 * block of the smallest order that fits.
+	 * Used by allocate()
+	 *
+	 * @param new_buffer The buffer to allocate, already checked by check_new_buffer()
+	 *
+	 * @return 1 if successful
+	 */
+	bool allocate_buddy(yamm_buffer* new_buffer);
+
+	/**
+	 * Returns the largest size that allocation_mode can allocate right now, for a
+	 * buffer without alignment or granularity, 0 if nothing can be allocated.
+	 * YAMM_BUDDY_FIT is limited by the largest free block and YAMM_TLSF_FIT by the
+	 * lower bound of the size class of the largest free buffer.
+	 * Used by populate()
+	 */
+	uint_64_t get_largest_satisfiable_size(int allocation_mode);
+
+	/**
+	 * Allocates the buffers drawn by populate() one by one with allocate_by_size(),
+	 * each size clipped by get_largest_satisfiable_size().
+	 * Used by populate() for a slab, YAMM_BUDDY_FIT and YAMM_TLSF_FIT
+	 */
+	std::vector<yamm_buffer*> populate_by_size(uint_64_t target_bytes,
+			yamm_size_distribution &size_distribution, int allocation_mode);
+
+	/**
+	 * Chooses the start address of a request of populate() in a copy of the free
+	 * buffers, following allocation_mode, and splits the free buffer it takes.
+	 * Used by populate()
+	 *
+	 * @param free_ends Start address -> end address of each free buffer
+	 * @param free_sizes (size, start address) of each free buffer
+	 * @param size The size of the request, at most the largest free buffer
+	 * @param allocation_mode The allocation mode, one of the list based modes
+	 * @param rover Where YAMM_NEXT_FIT resumes, moved after the request
+	 *
+	 * @return The start address of the request
+	 */
+	uint_64_t plan_request(std::map<uint_64_t, uint_64_t> &free_ends,
+			std::set<std::pair<uint_64_t, uint_64_t> > &free_sizes,
+			uint_64_t size, int allocation_mode, uint_64_t &rover);
+
+	/**
+	 * Computes the TLSF size class (first level and second level) of a free buffer size
+	 * Used by tlsf_insert(), tlsf_remove() and allocate_tlsf()
+	 */
+	static void tlsf_mapping(uint_64_t size, uint &fl, uint &sl);
+
+	/**
+	 * Adds a free buffer to the list of its TLSF size class
+	 * Used by index_free_buffer() and allocate_tlsf()
+	 */
+	void tlsf_insert(yamm_buffer* free_buffer);
+
+	/**
+	 * Removes a free buffer from the list of its TLSF size class
+	 * Used by unindex_free_buffer()
+	 */
+	void tlsf_remove(yamm_buffer* free_buffer);
+
+	/**
+	 * Allocates new_buffer in YAMM_TLSF_FIT mode: the request is rounded up to the next
+	 * size class and the bitmaps give the first non-empty class at least as large,
+	 * so any free buffer of that class fits. The buffer is placed at the lowest
+	 * aligned address of that free buffer.
+	 * Used by allocate()
+	 *
+	 * @param new_buffer The buffer to allocate, already checked by check_new_buffer()
+	 *
+	 * @return 1 if successful
+	 */
+	bool allocate_tlsf(yamm_buffer* new_buffer);
+
+	/**
+	 * Returns the first free or occupied slot of the slab in [first_slot, last_slot]
+	 * Used by allocate_slot(), get_free_ranges() and access_overlaps()
+	 *
+	 * @param is_free Look for a free slot, or for an occupied one
+	 *
+	 * @return The slot or YAMM_NO_SLOT if there is none
+	 */
+	uint_64_t find_slot(uint_64_t first_slot, uint_64_t last_slot, bool is_free);
+
+	/**
+	 * Allocates new_buffer in a free slot of [first_slot, last_slot] of this slab.
+	 * The random allocation modes start the bit scan from a random slot, the
+	 * other ones take the first free slot.
+	 * Used by allocate() and allocate_in_range()
+	 *
+	 * @param new_buffer The buffer to allocate, already checked by check_new_buffer()
+	 * @param allocation_mode The allocation mode
+	 * @param first_slot The first slot that can be used
+	 * @param last_slot The last slot that can be used
+	 *
+	 * @return 1 if successful
+	 */
+	bool allocate_slot(yamm_buffer* new_buffer, int allocation_mode,
+			uint_64_t first_slot, uint_64_t last_slot);
+
+	/**
+	 * Places new_buffer in a free slot of this slab and updates the counters
+	 * Used by allocate_slot() and insert_slot()
+	 */
+	void occupy_slot(yamm_buffer* new_buffer, uint_64_t slot);
+
+	/**
+	 * Inserts new_buffer in the slot that starts at its start address
+	 * Used by insert()
+	 *
+	 * @return 1 if successful
+	 */
+	bool insert_slot(yamm_buffer* new_buffer);
+
+	/**
+	 * Frees the slot of an occupied buffer of this slab and deletes the buffer
+	 * Used by deallocate()
+	 *
+	 * @return 1 if successful
+	 */
+	bool deallocate_slot(yamm_buffer* del);
+
+	/**
+	 * Replaces an occupied buffer with a free one, merged with its free neighbors
+	 * Used by deallocate() and compact(), del isn't deleted
+	 *
+	 * @return The free buffer that took its place
+	 */
+	yamm_buffer* release(yamm_buffer* del);
+
+	/**
+	 * Checks if compact() can move a buffer: it isn't static or inserted, and it
+	 * doesn't contain other buffers, since their addresses wouldn't move with it
+	 */
+	bool is_movable(yamm_buffer* buffer);
+
+	/**
+	 * Checks a buffer given to insert() and computes its end address
+	 *
+	 * @return 1 if it can be inserted somewhere
+	 */
+	bool check_inserted_buffer(yamm_buffer* new_buffer);
+
+	/**
+	 * Inserts a buffer checked by check_inserted_buffer() in the free buffer that
+	 * contains its start address
+	 * Used by insert() and insert_batch()
+	 *
+	 * @param free_buffer The buffer that contains the start address, it can be occupied
+	 *
+	 * @return 1 if the buffer fits in free_buffer
+	 */
+	bool insert_in_free_buffer(yamm_buffer* new_buffer, yamm_buffer* free_buffer);
+
+	/**
+	 * Adds [start_addr, end_addr] to the ranges if a buffer of size bytes aligned
+	 * to alignment fits in it, or if size is 0
+	 * Used by get_free_ranges()
+	 */
+	static void add_free_range(std::vector<yamm_access> &ranges,
+			uint_64_t start_addr, uint_64_t end_addr, uint_64_t size,
+			uint_64_t alignment);
+
+	/**
+	 * Returns the first occupied buffer in [start_addr, end_addr]
+	 * Used by access_overlaps()
+	 *
+	 * @param temp The buffer that contains start_addr, not used by a slab
+	 *
+	 * @return The buffer or a null handle if all the range is free
+	 */
+	yamm_buffer* find_overlapping_buffer(yamm_buffer* temp, uint_64_t start_addr,
+			uint_64_t end_addr);
+
+	/**
+	 * Finds a place for a buffer and adds it, allocate() without the event
+	 * Used by allocate() and resize()
+	 *
+	 * @return 1 if successful
+	 */
+	bool place(yamm_buffer* new_buffer, int allocation_mode);
+
+	/**
+	 * Finds a place for a buffer inside [lo, hi] and adds it, allocate_in_range()
+	 * without the event
+	 *
+	 * @return 1 if successful
+	 */
+	bool place_in_range(yamm_buffer* new_buffer, int allocation_mode,
+			uint_64_t lo, uint_64_t hi);
+
+	/**
+	 * Tells the observers of this buffer and of the buffers that contain it about a
+	 * change of its memory map. Without observers it's only a test of a counter.
+	 *
+	 * @param kind One of YAMM_EVENT_*
+	 * @param buffer The buffer that changed, NULL for a reset
+	 */
+	void notify(int kind, yamm_buffer* buffer, int allocation_mode,
+			uint_64_t old_start_addr, uint_64_t old_end_addr) {
+		if (__builtin_expect(number_of_observers != 0, 0))
+			notify_observers(kind, buffer, allocation_mode, old_start_addr,
+					old_end_addr);
+	}
+
+	/**
+	 * Builds the event and calls the observers
+	 * Used by notify()
+	 */
+	void notify_observers(int kind, yamm_buffer* buffer, int allocation_mode,
+			uint_64_t old_start_addr, uint_64_t old_end_addr);
+
+	/**
+	 * Returns the first occupied buffer or slot inside this buffer, in address order
+	 * Used by snapshot() and diff()
+	 */
+	yamm_buffer* first_occupied();
+
+	/**
+	 * Returns the occupied buffer or slot after buffer, in address order
+	 * Used by snapshot() and diff()
+	 */
+	yamm_buffer* next_occupied(yamm_buffer* buffer);
+
+	/**
+	 * Compares the buffers inside old_map and new_map, then the memory maps of the
+	 * buffers found in both
+	 * Used by diff()
+	 */
+	static void diff_level(yamm_buffer* old_map, yamm_buffer* new_map,
+			unsigned int level, std::vector<yamm_diff> &differences);
+
+	/**
+	 * Fits the contents to the new size of the buffer after resize()
+	 *
+	 * @param old_size Size of the contents
+	 */
+	void resize_contents(uint_64_t old_size);
+
+	/**
+	 * Counts the aligned start addresses of free_buffer where size bytes fit
+	 * Used by allocate_random_addr() and find_suitable_buffer_in_range()
+	 *
+	 * @param first_addr Set to the first of them
+	 *
+	 * @return The number of start addresses, 0 if size bytes don't fit
+	 */
+	static uint_64_t count_start_addrs(yamm_buffer* free_buffer, uint_64_t size,
+			uint_64_t alignment, uint_64_t alignment_mask, uint_64_t &first_addr);
+
+	/**
+	 * Allocates new_buffer in YAMM_RANDOM_ADDR_FIT mode: every aligned start address
+	 * where it fits, over all the free buffers, is equally likely. A free buffer is
+	 * drawn from free_space_tree with a weight of (size - new_buffer size + alignment),
+	 * in O(log n), and accepted in proportion to its number of start addresses.
+	 * Used by allocate()
+	 *
+	 * @param new_buffer The buffer to allocate, already checked by check_new_buffer()
+	 *
+	 * @return 1 if successful
+	 */
+	bool allocate_random_addr(yamm_buffer* new_buffer);
+
+	/**
+	 * Applies a change in the statistics of the memory map of this buffer to
+	 * its level_statistics and to the ones of all the buffers that contain it
+	 * Used by add(), deallocate(), index_free_buffer() and unindex_free_buffer()
+	 *
+	 * @param delta The change in statistics
+	 * @param depth The recursion level of the change, relative to this buffer
+	 * @param increase If set to 1 delta is added, otherwise it is subtracted
+	 */
+	void update_statistics(const yamm_statistics &delta, uint depth,
+			bool increase);
+
 	/**
 	 * It merges free buffers after deallocation
 	 *
@@ -172,12 +691,51 @@ protected:
 	 *
 	 * @param size The size of the new buffer
 	 * @param alignment The alignment of the new buffer
+	 * @param alignment_mask The mask of the alignment, computed by compute_mask()
 	 * @param alloc_mode The allocation mode, dictates the search rules
 	 *
 	 * @return A suitable free buffer if it exists or NULL otherwise
 	 */
-	yamm_buffer* find_suitable_buffer(uint_64_t size, uint_32_t alignment,
-			int alloc_mode);
+	yamm_buffer* find_suitable_buffer(uint_64_t size, uint_64_t alignment,
+			uint_64_t alignment_mask, int alloc_mode);
+
+	/**
+	 * Same as find_suitable_buffer() but only the part of each free buffer that lies in
+	 * [lo, hi] is considered. The candidates are taken from free_by_addr so the search
+	 * is O(log n + k) for k free buffers intersecting the window. YAMM_NEXT_FIT starts
+	 * with next_fit_rover if it intersects the window and wraps around once.
+	 * Used by allocate_in_range()
+	 *
+	 * @param size The size of the new buffer
+	 * @param alignment The alignment of the new buffer
+	 * @param alignment_mask The mask of the alignment, computed by compute_mask()
+	 * @param alloc_mode The allocation mode, dictates the search and placement rules
+	 * @param lo First address of the window
+	 * @param hi Last address of the window (inclusive)
+	 * @param start_addr Start address of the new buffer, computed according to alloc_mode
+	 *
+	 * @return A suitable free buffer if it exists or NULL otherwise
+	 */
+	yamm_buffer* find_suitable_buffer_in_range(uint_64_t size,
+			uint_64_t alignment, uint_64_t alignment_mask, int alloc_mode,
+			uint_64_t lo, uint_64_t hi, uint_64_t &start_addr);
+
+	/**
+	 * Creates the free buffer that spans the whole memory map the first time
+	 * something is placed inside this buffer, nothing is done for a slab
+	 * Used by find_suitable_buffer(), find_suitable_buffer_in_range() and insert()
+	 */
+	void init_free_buffer();
+
+	/**
+	 * Checks that new_buffer can be allocated inside this buffer
+	 * Used by allocate() and allocate_in_range()
+	 *
+	 * @param new_buffer The buffer to allocate
+	 *
+	 * @return 1 if it can be allocated
+	 */
+	bool check_new_buffer(yamm_buffer* new_buffer);
 
 	/**
 	 *  Same as get_buffer() but it can also return free buffer, used internally.
@@ -202,6 +760,40 @@ protected:
 	 */
 	void print_free(FILE* fp);
 
+	/**
+	 * Checks one buffer of the memory map of this buffer against its direct neighbors:
+	 * continuity, size, merged free buffers, the next/prev links and the
+	 * next_free/prev_free links. It triggers an error message and exits if
+	 * any inconsistency is found.
+	 *
+	 * If YAMM_DEBUG_CHECKS is defined it is called by add() and deallocate() for
+	 * the buffers they touched, so the memory map is checked continuously.
+	 *
+	 * @param buffer A buffer linked in the memory map of this buffer
+	 *
+	 * @return Returns 1 if no errors are found
+	 */
+	bool check_local_consistency(yamm_buffer* buffer);
+
+	/**
+	 * Same as check_local_consistency() but also checks the direct neighbors
+	 * of buffer against their own neighbors
+	 *
+	 * @param buffer A buffer linked in the memory map of this buffer
+	 *
+	 * @return Returns 1 if no errors are found
+	 */
+	bool check_consistency_around(yamm_buffer* buffer);
+
+	/**
+	 * Sums up the memory maps of this buffer and of the buffers inside it by walking
+	 * them. The memory map of this buffer goes in levels[depth], the ones of its
+	 * buffers in levels[depth + 1] and so on.
+	 * Used by check_address_space_consistency() to check level_statistics.
+	 */
+	void compute_level_statistics(std::vector<yamm_statistics> &levels,
+			uint depth);
+
 	/**
 	 *	Function that prints the size argument according to it's size (Gb,Mb,Kb,bytes).
 	 *
@@ -269,6 +861,111 @@ public:
 	 */
 	yamm_buffer* allocate_by_size(uint_64_t size, int allocation_mode);
 
+	/**
+	 * This function tries to allocate the buffer in the memory, according to
+	 * allocation_mode, so that it lies entirely in the address window [lo, hi].
+	 * The allocation mode is applied only to the free buffers intersecting the window.
+	 *
+	 * @param new_buffer The new buffer that is going to get allocated
+	 * @param allocation_mode The allocation mode according to which the allocation will be done
+	 * @param lo First address of the window
+	 * @param hi Last address of the window (inclusive)
+	 *
+	 * @return It returns 1 if the buffer was successfully allocated or 0 otherwise.
+	 */
+	bool allocate_in_range(yamm_buffer* new_buffer, int allocation_mode,
+			uint_64_t lo, uint_64_t hi);
+
+	/**
+	 * Same as allocate_by_size() but the buffer has to lie in the address window [lo, hi]
+	 *
+	 * @param size The size of the new buffer
+	 * @param allocation_mode The allocation mode according to which the allocation will be done
+	 * @param lo First address of the window
+	 * @param hi Last address of the window (inclusive)
+	 *
+	 * @return It returns a buffer handle if successful or a null handle otherwise
+	 */
+	yamm_buffer* allocate_by_size_in_range(uint_64_t size, int allocation_mode,
+			uint_64_t lo, uint_64_t hi);
+
+	/**
+	 * Turns this buffer into a slab of fixed-size slots. Each buffer allocated
+	 * inside takes a whole slot, so allocate() and deallocate() only scan and update a
+	 * bitmap instead of splitting and merging free buffers. The slots are still
+	 * buffers for get_buffer(), get_buffers_in_range() and deallocate_by_addr().
+	 *
+	 * The buffer can't be free or contain other buffers. Alignments have to divide
+	 * the slot size and the start address of the slab.
+	 *
+	 * @param slot_size The size of a slot, 0 turns an empty slab back into a regular buffer
+	 *
+	 * @return 1 if successful, 0 if the buffer can't be a slab
+	 */
+	bool make_slab(uint_64_t slot_size);
+
+	/**
+	 *  Returns 1 if this buffer is a slab
+	 */
+	bool is_slab() {
+		return (container_state) && (container_state->slab_slot_size != 0);
+	}
+
+	/**
+	 *  Returns the slot size of the slab, 0 if this buffer isn't a slab
+	 */
+	uint_64_t get_slot_size() {
+		return container_state ? container_state->slab_slot_size : 0;
+	}
+
+	/**
+	 * Fills this buffer up to a target usage in one pass. The free buffers are copied
+	 * once from the free buffer indexes and each size drawn is planned against the copy,
+	 * following allocation_mode, clipped to what is left to reach the target and to the
+	 * largest free buffer left, so there are no failed searches. The buffers are then
+	 * placed in one walk over the free buffers, in address order.
+	 * A slab, YAMM_BUDDY_FIT and YAMM_TLSF_FIT allocate the sizes one by one instead,
+	 * clipped by get_largest_satisfiable_size().
+	 *
+	 * @param target_usage The usage to reach, as a percentage like get_usage_statistics()
+	 * @param size_distribution Draws the sizes of the buffers
+	 * @param allocation_mode The allocation mode according to which the allocations will be done
+	 *
+	 * @return The buffers allocated, it stops early if nothing fits anymore
+	 */
+	std::vector<yamm_buffer*> populate(double target_usage,
+			yamm_size_distribution &size_distribution, int allocation_mode);
+
+	/**
+	 * Slides the movable buffers toward low addresses, keeping their order and alignment,
+	 * so the free space gathers in one free buffer at the end. A buffer is movable if it
+	 * isn't static or inserted and contains no other buffers; the free space between
+	 * the buffers that stay in place is compacted separately.
+	 *
+	 * A buffer keeps its contents and its name when moved, only its addresses change.
+	 *
+	 * @param listener Told about every move, can be NULL
+	 * @param max_moves Maximum number of moves done by this call, 0 for no limit.
+	 * Calling it again continues the compaction.
+	 *
+	 * @return The number of buffers moved, 0 once the memory is compacted
+	 */
+	uint compact(yamm_relocation_listener* listener = NULL, uint max_moves = 0);
+
+	/**
+	 * Changes the size of an allocated buffer, keeping its address if possible:
+	 * it shrinks in place, leaving its tail free, and grows into the free buffer after it.
+	 * Otherwise a movable buffer (see compact()) is allocated again in a larger free buffer.
+	 * The contents are kept up to the smaller of the two sizes.
+	 *
+	 * @param buffer The buffer resized, allocated inside this buffer
+	 * @param new_size The new size, rounded up to the granularity of the buffer
+	 * @param allocation_mode The allocation mode used if the buffer has to move
+	 *
+	 * @return 1 if successful, 0 if the buffer can't grow and stays as it was
+	 */
+	bool resize(yamm_buffer* buffer, uint_64_t new_size, int allocation_mode);
+
 	/**
 	 * This function tries to insert a buffer in the memory with the specified start_addr and size.
 	 * The function makes use of the field size and the start_addr contained in the specified buffer.
@@ -291,6 +988,27 @@ public:
 	 */
 	yamm_buffer* insert_access(yamm_access* access);
 
+	/**
+	 * Inserts many buffers at once, like insert() but sorted by start address and
+	 * placed in one pass over the memory, instead of one search from the first buffer
+	 * for each of them. A buffer that collides with another one, including one
+	 * inserted before it in the same batch, isn't inserted.
+	 *
+	 * @param buffers The buffers that are going to be inserted, in any order
+	 *
+	 * @return For each buffer, 1 if it was inserted
+	 */
+	std::vector<bool> insert_batch(std::vector<yamm_buffer*> &buffers);
+
+	/**
+	 * Like insert_batch(), with a buffer created from each access
+	 *
+	 * @param accesses The accesses from which the buffers are created
+	 *
+	 * @return For each access, the buffer inserted or a null handle
+	 */
+	std::vector<yamm_buffer*> insert_accesses(std::vector<yamm_access> &accesses);
+
 	// Functions to do with contents
 
 	/**
@@ -385,6 +1103,21 @@ public:
 	std::vector<yamm_buffer> get_buffers_in_range(uint_64_t start_addr,
 			uint_64_t end_addr);
 
+	/**
+	 * It searches for the free space between start_addr and end_addr, using the free
+	 * buffers sorted by address so only the free buffers in that span are visited.
+	 * Each range is a free buffer cut to [start_addr, end_addr].
+	 *
+	 * @param start_addr The start address of the memory span on which the search is done
+	 * @param end_addr The end address of the memory span on which the search is done
+	 * @param size If not 0, only the ranges where a buffer of this size fits are returned
+	 * @param alignment Start address alignment of that buffer
+	 *
+	 * @return Returns the free ranges sorted by address, or an empty vector if the parameters are invalid
+	 */
+	std::vector<yamm_access> get_free_ranges(uint_64_t start_addr,
+			uint_64_t end_addr, uint_64_t size = 0, uint_64_t alignment = 1);
+
 	/**
 	 * It searches for all buffers that span in the address range specified by access.
 	 * The address range is computed using start_addr and size fields of yamm_access.
@@ -407,6 +1140,20 @@ public:
 	// Other functions
 	bool access_overlaps(yamm_access* access);
 
+	/**
+	 * Checks many accesses at once, like access_overlaps() but sorted by start address
+	 * and checked in one pass over the memory, instead of one search from the first
+	 * buffer for each of them. The part of an access outside the memory overlaps nothing.
+	 *
+	 * @param accesses The accesses checked, in any order
+	 * @param overlapping_buffers Filled with an occupied buffer that overlaps each access,
+	 * or a null handle
+	 *
+	 * @return For each access, 1 if it overlaps an occupied buffer
+	 */
+	std::vector<bool> access_overlaps(std::vector<yamm_access> &accesses,
+			std::vector<yamm_buffer*> &overlapping_buffers);
+
 	/**
 	 *  Returns the memory structure as a string.
 	 *
@@ -429,13 +1176,112 @@ public:
 	double get_fragmentation();
 
 	/**
-	 *  Returns the percentage of free memory compared to the whole memory.
+	 *  Returns the percentage of used memory compared to the whole memory.
 	 */
 	double get_usage_statistics();
 
+	/**
+	 *  Returns the total size of the free buffers contained.
+	 *  If nothing was allocated inside yet, the whole buffer is free.
+	 */
+	uint_64_t get_free_bytes() {
+		return (first || is_slab()) ? container_state->free_bytes : size;
+	}
+
+	/**
+	 *  Returns the total size of the occupied buffers contained.
+	 */
+	uint_64_t get_used_bytes() {
+		return size - get_free_bytes();
+	}
+
+	/**
+	 *  Returns the number of occupied buffers contained.
+	 */
+	uint get_number_of_buffers() {
+		return number_of_buffers;
+	}
+
+	/**
+	 *  Returns the number of free buffers contained.
+	 */
+	uint get_number_of_free_buffers() {
+		return number_of_free_buffers;
+	}
+
+	/**
+	 *  Returns the size of the largest free buffer contained.
+	 */
+	uint_64_t get_largest_free_extent() {
+		if (is_slab())
+			return number_of_free_buffers ? container_state->slab_slot_size : 0;
+		if (!first)
+			return size;
+		if (container_state->free_by_size.empty())
+			return 0;
+		return container_state->free_by_size.rbegin()->first.first;
+	}
+
+	/**
+	 *  Returns the statistics of the memory maps found at a given recursion level
+	 *  below this buffer, summed up. Level 0 is the memory map of this buffer.
+	 *
+	 *  @param level The recursion level relative to this buffer
+	 *
+	 *  @return The statistics, all 0 if there is no memory map at that level
+	 */
+	yamm_statistics get_level_statistics(uint level);
+
+	/**
+	 *  Returns the statistics of all the memory maps contained by this buffer,
+	 *  at any recursion level, summed up.
+	 */
+	yamm_statistics get_tree_statistics();
+
+	/**
+	 *  Returns the number of recursion levels below this buffer which have memory maps
+	 */
+	uint get_number_of_levels() {
+		return container_state ? container_state->level_statistics.size() : 0;
+	}
+
+	/**
+	 *  Returns a log2 histogram of the free buffers contained.
+	 *  Entry i holds the number of free buffers with a size in [2^i, 2^(i+1)).
+	 *
+	 *  @return A vector with 64 entries
+	 */
+	std::vector<uint> get_free_histogram();
+
+	/**
+	 *  Returns the external fragmentation index as a percentage: how much of
+	 *  the free memory is outside of the largest free buffer.
+	 *  0 means all the free memory is contiguous.
+	 */
+	double get_external_fragmentation();
+
+	/**
+	 *  Computes the largest size that can currently be allocated with the given
+	 *  alignment and granularity. The free buffers are checked from the largest one
+	 *  and the search stops at the first one that isn't larger than the best size
+	 *  found. Alignment and granularity can take at most (alignment + granularity - 2)
+	 *  bytes from a free buffer, so usually only the free buffers within that many
+	 *  bytes of the largest one are checked. Worst case, when the alignment is close
+	 *  to the size of the free buffers and none of them has a suitable start address,
+	 *  all of them are checked: O(n) for n free buffers.
+	 *
+	 *  @param alignment The start address alignment of the buffer
+	 *  @param granularity The granularity of the buffer
+	 *
+	 *  @return The largest size that would be allocated successfully or 0 if nothing fits
+	 */
+	uint_64_t largest_allocatable(uint_64_t alignment, uint_64_t granularity);
+
 	/**
 	 * This function is used to do a self-check on the memory model to see if all
-	 * the buffers are correctly allocated by the model.
+	 * the buffers are correctly allocated by the model. The memory maps nested inside
+	 * are checked too, and the counters, the free buffer indexes, the histogram and
+	 * the statistics of each recursion level are compared with the buffers.
 	 * It will trigger an error message if any inconsistency is found.
 	 * It is used for debug purposes.
 	 *
@@ -443,6 +1289,72 @@ public:
 	 */
 	bool check_address_space_consistency();
 
+	/**
+	 * Same checks as check_address_space_consistency() plus the free buffer links,
+	 * done by a pool of threads: the buffers, the counters, the free buffer indexes,
+	 * the histogram and the statistics of the recursion levels of each memory map.
+	 * Big memory maps are split in chunks and each contained memory map or slab is
+	 * checked by its own task. Nothing is printed and the simulation isn't stopped.
+	 *
+	 * @param number_of_threads Size of the pool, 0 to use one thread per core
+	 *
+	 * @return All the inconsistencies found, empty if the memory is consistent
+	 */
+	std::vector<yamm_violation> check_address_space_consistency_parallel(
+			uint number_of_threads);
+
+	/**
+	 * Attaches an observer that is told about every allocation, insertion, deallocation,
+	 * resize, move and reset in this memory map and in all the memory maps nested in it.
+	 * A buffer has at most one observer, the observers of the buffers that contain it
+	 * are told too. Without any observer the events cost a test of a counter.
+	 *
+	 * @param new_observer The observer, not deleted by the buffer, or NULL to detach it
+	 */
+	void set_observer(yamm_observer* new_observer);
+
+	yamm_observer* get_observer() {
+		return container_state ? container_state->observer : NULL;
+	}
+
+	/**
+	 * Returns the searches, merges and lookups done by all the memory maps since the
+	 * start or since the last reset_perf_counters(). The counters stay at 0 unless
+	 * the library is compiled with YAMM_PERF_COUNTERS defined.
+	 */
+	static yamm_perf_counters get_perf_counters();
+
+	/**
+	 * Sets all the performance counters to 0
+	 */
+	static void reset_perf_counters();
+
+	/**
+	 * Copies this buffer and the memory maps inside it, without the contents.
+	 * The copy keeps the addresses, names and static flags, so it can be compared
+	 * with this buffer later by diff().
+	 *
+	 * @return The copy, deleted by the user
+	 */
+	yamm_buffer* snapshot();
+
+	/**
+	 * Compares two memory maps, e.g. a snapshot() and the live memory. The buffers of
+	 * each level are sorted by address so both maps are walked together in linear time.
+	 * A buffer found in both (same start address and name) is compared with its size
+	 * and static flag, then the memory maps inside it are compared. A buffer removed
+	 * and added again with the same name is reported as moved, and the memory maps
+	 * inside the buffers added, removed or moved aren't compared.
+	 *
+	 * @param old_map The memory map before
+	 * @param new_map The memory map after
+	 *
+	 * @return The differences in address order, each buffer found in both maps followed by
+	 * the differences inside it, empty if the maps are the same
+	 */
+	static std::vector<yamm_diff> diff(yamm_buffer* old_map,
+			yamm_buffer* new_map);
+
 	std::string get_name() {
 		return this->name;
 	}
@@ -468,11 +1380,15 @@ public:
 		return this->is_static;
 	}
 
-	uint_32_t get_start_addr_alignment() {
+	bool get_is_inserted() {
+		return this->is_inserted;
+	}
+
+	uint_64_t get_start_addr_alignment() {
 		return this->start_addr_alignment;
 	}
 
-	uint_32_t get_granularity() {
+	uint_64_t get_granularity() {
 		return this->granularity;
 	}
 
@@ -508,7 +1424,7 @@ public:
 		this->end_addr = this->start_addr + this->size - 1;
 	}
 
-	void set_start_addr_alignment(uint_32_t alignment) {
+	void set_start_addr_alignment(uint_64_t alignment) {
 
 		if (this->next || this->prev) {
 			if (!disable_warnings)
@@ -519,9 +1435,10 @@ public:
 		}
 
 		this->start_addr_alignment = alignment;
+		this->start_addr_alignment_mask = compute_mask(alignment);
 	}
 
-	void set_granularity(uint_32_t granularity) {
+	void set_granularity(uint_64_t granularity) {
 
 		if (this->next || this->prev) {
 			if (!disable_warnings)
@@ -532,6 +1449,7 @@ public:
 		}
 
 		this->granularity = granularity;
+		this->granularity_mask = compute_mask(granularity);
 	}
 
 	/**
@@ -22,41 +22,54 @@
 
 using namespace yamm_ns;
 
-uint_64_t yamm_buffer::get_aligned_addr(const uint_32_t &start_addr_alignment,
-		yamm_buffer* temp) {
+uint_64_t yamm_buffer::get_aligned_addr(uint_64_t start_addr_alignment,
+		uint_64_t alignment_mask, yamm_buffer* temp) {
 
-	if (start_addr_alignment == 1)
-		return temp->start_addr;
+	uint_64_t align;
 
-	uint_32_t align = (start_addr_alignment
-			- temp->start_addr % start_addr_alignment);
-	align = align % start_addr_alignment;
+	// Power of two alignments only need a mask
+	if (alignment_mask != YAMM_NO_MASK)
+		align = (0 - temp->start_addr) & alignment_mask;
+	else
+		align = (start_addr_alignment - temp->start_addr % start_addr_alignment)
+				% start_addr_alignment;
 
 	// If the buffer displacement start address fits in the buffer return
 	// the new start address
-	if ((temp->start_addr + align) <= temp->end_addr)
+	if (align <= temp->end_addr - temp->start_addr)
 		return temp->start_addr + align;
 
 	return temp->end_addr + 1;
 }
 
 uint_64_t yamm_buffer::compute_size_with_gran(uint_64_t size,
-		uint_32_t granularity) {
+		uint_64_t granularity, uint_64_t granularity_mask) {
+
+	if (granularity_mask != YAMM_NO_MASK)
+		return size + ((0 - size) & granularity_mask);
+
 	return size + (granularity - size % granularity) % granularity;
 }
 
-uint_64_t yamm_buffer::compute_size_with_align(
-		const uint_32_t &start_addr_alignment, yamm_buffer* temp) {
-	return temp->end_addr - get_aligned_addr(start_addr_alignment, temp) + 1;
+uint_64_t yamm_buffer::compute_size_with_align(uint_64_t start_addr_alignment,
+		uint_64_t alignment_mask, yamm_buffer* temp) {
+	return temp->end_addr
+			- get_aligned_addr(start_addr_alignment, alignment_mask, temp) + 1;
 }
 
 void yamm_buffer::get_closest_aligned_addr(yamm_buffer* temp) {
 
 	// Closest aligned address to the right and left
-	uint_64_t negalign = (start_addr % start_addr_alignment)
-			% start_addr_alignment;
-	uint_64_t posalign = (start_addr_alignment
-			- start_addr % start_addr_alignment) % start_addr_alignment;
+	uint_64_t negalign;
+	uint_64_t posalign;
+
+	if (start_addr_alignment_mask != YAMM_NO_MASK) {
+		negalign = start_addr & start_addr_alignment_mask;
+		posalign = (0 - start_addr) & start_addr_alignment_mask;
+	} else {
+		negalign = start_addr % start_addr_alignment;
+		posalign = (start_addr_alignment - negalign) % start_addr_alignment;
+	}
 
 	// Apply the lower one of the two
 	if ((negalign <= posalign) && (start_addr - negalign >= temp->start_addr))
@@ -69,9 +82,11 @@ void yamm_buffer::get_closest_aligned_addr(yamm_buffer* temp) {
 bool yamm_buffer::compute_start_addr(yamm_buffer* temp, int alloc_mode) {
 
 	switch (alloc_mode) {
-	// First fit and best fit have the same behavior
-	case YAMM_FIRST_FIT ... YAMM_BEST_FIT: {
-		start_addr = get_aligned_addr(start_addr_alignment, temp);
+	// First fit, best fit and next fit have the same behavior
+	case YAMM_FIRST_FIT ... YAMM_BEST_FIT:
+	case YAMM_NEXT_FIT: {
+		start_addr = get_aligned_addr(start_addr_alignment,
+				start_addr_alignment_mask, temp);
 		if (start_addr > temp->end_addr)
 			return 0;
 		else
@@ -92,20 +107,25 @@ bool yamm_buffer::compute_start_addr(yamm_buffer* temp, int alloc_mode) {
 			else
 				start_addr = temp->start_addr;
 
+		} else {
+			// Pick one of the aligned start addresses where the buffer fits
+			uint_64_t first_addr = get_aligned_addr(start_addr_alignment,
+					start_addr_alignment_mask, temp);
 
+			if ((first_addr > temp->end_addr)
+					|| (size - 1 > temp->end_addr - first_addr))
+				return 0;
 
-		} else {
-			if ((temp->end_addr - temp->start_addr - size + 1
-					- start_addr_alignment) > 0)
-				// Same as above but taking in consideration the alignment
-				start_addr = temp->start_addr
-						+ (generate_rand64()
-								% (temp->end_addr - temp->start_addr - size + 1
-										- start_addr_alignment));
+			uint_64_t slots = temp->end_addr - (size - 1) - first_addr;
+			if (start_addr_alignment_mask != YAMM_NO_MASK)
+				slots = slots >> __builtin_ctzll(start_addr_alignment);
 			else
-				start_addr = temp->start_addr;
+				slots = slots / start_addr_alignment;
 
-			this->get_closest_aligned_addr(temp);
+			start_addr = first_addr;
+			if (slots)
+				start_addr += (generate_rand64() % (slots + 1))
+						* start_addr_alignment;
 		}
 		break;
 	}
@@ -130,7 +150,7 @@ bool yamm_buffer::compute_start_addr(yamm_buffer* temp, int alloc_mode) {
 }
 
 yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
-		uint_32_t alignment, int alloc_mode) {
+		uint_64_t alignment, uint_64_t alignment_mask, int alloc_mode) {
 
 	if (alloc_mode == YAMM_BEST_FIT_RND)
 		alloc_mode = YAMM_BEST_FIT;
@@ -138,25 +158,14 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 	if (alloc_mode == YAMM_FIRST_FIT_RND)
 		alloc_mode = YAMM_FIRST_FIT;
 
-	yamm_buffer* temp = first_free;
-
 	// Check if there are any free buffers inside and if this is a new allocation inside
 	// an existing buffer create one
-	if (temp == NULL) {
-		if (first)
-			return NULL;
-		else {
-			first_free = new yamm_buffer();
-			first_free->start_addr = start_addr;
-			first_free->size = this->size;
-			first_free->end_addr = first_free->start_addr + first_free->size
-					- 1;
-			first_free->is_free = 1;
-			first = first_free;
-			delete temp;
-			temp = first_free;
-		}
-	}
+	init_free_buffer();
+
+	yamm_buffer* temp = first_free;
+
+	if (temp == NULL)
+		return NULL;
 
 	// Size available inside the free buffer that we search for
 	uint_64_t tsize = temp->size;
@@ -165,15 +174,16 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 	case YAMM_FIRST_FIT: {
 
 		if (alignment != 1) {
-			tsize = compute_size_with_align(alignment, temp);
+			tsize = compute_size_with_align(alignment, alignment_mask, temp);
 		}
 
 		// Look for the first free buffer that fits
 		while ((temp->next_free) && (size > tsize)) {
 			temp = temp->next_free;
+			YAMM_COUNT(nodes_visited);
 			if (size <= temp->size)
 				if (alignment != 1)
-					tsize = compute_size_with_align(alignment, temp);
+					tsize = compute_size_with_align(alignment, alignment_mask, temp);
 				else
 					tsize = temp->size;
 			else {
@@ -194,22 +204,23 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 		yamm_buffer* best_temp = NULL;
 		int set = 0;
 
-		if (compute_size_with_align(alignment, temp) >= size)
+		if (compute_size_with_align(alignment, alignment_mask, temp) >= size)
 			best_temp = temp;
 
 		// Traverse the whole memory looking for the smallest free buffer that fits.
 		while (temp->next_free) {
 
 			temp = temp->next_free;
+			YAMM_COUNT(nodes_visited);
 
 			if (size <= temp->size) {
 				if (best_temp == NULL)
 					if (alignment != 1)
-						tsize = compute_size_with_align(alignment, temp);
+						tsize = compute_size_with_align(alignment, alignment_mask, temp);
 					else
 						tsize = temp->size;
 				else if ((alignment != 1) && (temp->size < best_temp->size))
-					tsize = compute_size_with_align(alignment, temp);
+					tsize = compute_size_with_align(alignment, alignment_mask, temp);
 				else
 					tsize = temp->size;
 
@@ -226,7 +237,7 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 		}
 
 		if (best_temp)
-			if (compute_size_with_align(alignment, best_temp) >= size)
+			if (compute_size_with_align(alignment, alignment_mask, best_temp) >= size)
 				return best_temp;
 			else
 				return NULL;
@@ -244,11 +255,12 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 		// Traverse the whole memory looking for the largest buffer that fits
 		while (temp->next_free) {
 			temp = temp->next_free;
+			YAMM_COUNT(nodes_visited);
 
 			if (size <= temp->size) {
 				if (!found)
 					if (alignment != 1) {
-						tsize = compute_size_with_align(alignment, temp);
+						tsize = compute_size_with_align(alignment, alignment_mask, temp);
 						found = 1;
 					} else {
 						tsize = temp->size;
@@ -262,7 +274,7 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 			}
 		}
 
-		if (compute_size_with_align(alignment, uniform_temp) >= size)
+		if (compute_size_with_align(alignment, alignment_mask, uniform_temp) >= size)
 			return uniform_temp;
 		else
 			return NULL;
@@ -277,13 +289,14 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 		yamm_buffer* temp_prev;
 
 		// Find the buffer randomized above
+		YAMM_COUNT_N(nodes_visited, rnd_buffer);
 		while (buffer_cnt--) {
 			temp = temp->next_free;
 		}
 
 		if (size <= temp->size) {
 			if (alignment != 1)
-				tsize = compute_size_with_align(alignment, temp);
+				tsize = compute_size_with_align(alignment, alignment_mask, temp);
 			else
 				tsize = temp->size;
 		} else
@@ -295,14 +308,16 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 		temp_prev = temp;
 
 		// If we can't allocate in the random buffer we go around it for a suitable one
+		YAMM_COUNT(fallbacks);
 		while ((temp->next_free) || (temp_prev->prev_free)) {
 			// Check buffer to the "right"
 			if (temp->next_free) {
 				temp = temp->next_free;
+				YAMM_COUNT(nodes_visited);
 
 				if (size <= temp->size)
 					if (alignment != 1)
-						tsize = compute_size_with_align(alignment, temp);
+						tsize = compute_size_with_align(alignment, alignment_mask, temp);
 					else
 						tsize = temp->size;
 				else
@@ -314,10 +329,11 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 			// Check buffer to the "left"
 			if (temp_prev->prev_free) {
 				temp_prev = temp_prev->prev_free;
+				YAMM_COUNT(nodes_visited);
 
 				if (size <= temp_prev->size)
 					if (alignment != 1)
-						tsize = compute_size_with_align(alignment, temp_prev);
+						tsize = compute_size_with_align(alignment, alignment_mask, temp_prev);
 					else
 						tsize = temp_prev->size;
 				else
@@ -332,6 +348,38 @@ yamm_buffer* yamm_buffer::find_suitable_buffer(uint_64_t size,
 		break;
 	}
 
+	case YAMM_NEXT_FIT: {
+
+		// Resume from where the last search ended and wrap around once
+		yamm_buffer* start =
+				container_state->next_fit_rover ?
+						container_state->next_fit_rover : first_free;
+		temp = start;
+
+		do {
+			if (size <= temp->size) {
+				if (alignment != 1)
+					tsize = compute_size_with_align(alignment, alignment_mask, temp);
+				else
+					tsize = temp->size;
+
+				if (tsize >= size)
+					return temp;
+			}
+
+			if (temp->next_free)
+				temp = temp->next_free;
+			else {
+				temp = first_free;
+				YAMM_COUNT(fallbacks);
+			}
+			YAMM_COUNT(nodes_visited);
+		} while (temp != start);
+
+		return NULL;
+		break;
+	}
+
 	default: {
 		return NULL;
 		break;
@@ -343,6 +391,22 @@ void yamm_buffer::add(yamm_buffer* new_buffer, yamm_buffer* container_buffer) {
 
 	yamm_buffer* temp_prev = new yamm_buffer;
 
+	new_buffer->parent = this;
+
+	yamm_statistics delta;
+	delta.used_bytes = new_buffer->size;
+	delta.number_of_buffers = 1;
+	update_statistics(delta, 0, 1);
+
+	// An inserted buffer can bring its own memory maps
+	for (uint level = 0; level < new_buffer->get_number_of_levels(); ++level)
+		update_statistics(new_buffer->container_state->level_statistics[level],
+				level + 1, 1);
+
+	// The free buffer is going to be resized or replaced so it leaves the statistics until it's relinked
+	unindex_free_buffer(container_buffer);
+	bool container_remains = (new_buffer->end_addr < container_buffer->end_addr);
+
 	// First, check if there is a displacement caused by allocation mode or alignment
 	if (new_buffer->start_addr > container_buffer->start_addr) {
 		temp_prev->start_addr = container_buffer->start_addr;
@@ -359,14 +423,264 @@ void yamm_buffer::add(yamm_buffer* new_buffer, yamm_buffer* container_buffer) {
 				- container_buffer->start_addr + 1;
 	}
 
-	if (temp_prev->is_free)
+	if (temp_prev->is_free) {
 		link_in_list(temp_prev, new_buffer, container_buffer);
-	else {
+		index_free_buffer(temp_prev);
+	} else {
 		// We didn't need another buffer
 		delete temp_prev;
 		link_in_list(NULL, new_buffer, container_buffer);
 	}
 
+	if (container_remains)
+		index_free_buffer(container_buffer);
+
+#ifdef YAMM_DEBUG_CHECKS
+	check_consistency_around(new_buffer);
+#endif
+
+}
+
+yamm_buffer* yamm_buffer::find_suitable_buffer_in_range(uint_64_t size,
+		uint_64_t alignment, uint_64_t alignment_mask, int alloc_mode,
+		uint_64_t lo, uint_64_t hi, uint_64_t &start_addr) {
+
+	init_free_buffer();
+
+	// The first free buffer that intersects the window is either the last one
+	// starting at or before lo or the first one starting after it
+	std::map<uint_64_t, yamm_buffer*>::iterator it =
+			container_state->free_by_addr.upper_bound(lo);
+	if (it != container_state->free_by_addr.begin()) {
+		--it;
+		if (it->second->end_addr < lo)
+			++it;
+	}
+
+	yamm_buffer* found = NULL;
+	uint_64_t found_lo = 0;
+	uint_64_t found_hi = 0;
+	uint_64_t found_aligned = 0;
+	uint_32_t number_of_fits = 0;
+	uint_64_t number_of_addrs = 0;
+
+	// Next fit resumes from the rover if it's inside the window, then wraps around
+	// to the start of the window and stops at the rover
+	std::map<uint_64_t, yamm_buffer*>::iterator window_begin = it;
+	std::map<uint_64_t, yamm_buffer*>::iterator stop =
+			container_state->free_by_addr.end();
+	yamm_buffer* rover = container_state->next_fit_rover;
+	bool wrap_around = 0;
+
+	if ((alloc_mode == YAMM_NEXT_FIT) && (rover) && (rover->end_addr >= lo)
+			&& (rover->start_addr <= hi)) {
+		it = container_state->free_by_addr.find(rover->start_addr);
+		wrap_around = (it != window_begin);
+	}
+
+	std::map<uint_64_t, yamm_buffer*>::iterator resumed_at = it;
+
+	while (1) {
+
+		for (; (it != stop) && (it->first <= hi); ++it) {
+
+			yamm_buffer* temp = it->second;
+			YAMM_COUNT(nodes_visited);
+
+			// Part of the free buffer inside the window
+			uint_64_t window_lo = (temp->start_addr > lo) ? temp->start_addr : lo;
+			uint_64_t window_hi = (temp->end_addr < hi) ? temp->end_addr : hi;
+
+			uint_64_t aligned = window_lo;
+			if (alignment_mask != YAMM_NO_MASK)
+				aligned += (0 - window_lo) & alignment_mask;
+			else
+				aligned += (alignment - window_lo % alignment) % alignment;
+
+			// Compare sizes minus one so a window that ends at the last address doesn't overflow
+			if ((aligned < window_lo) || (aligned > window_hi)
+					|| (size - 1 > window_hi - aligned))
+				continue;
+
+			bool take;
+
+			switch (alloc_mode) {
+			case YAMM_FIRST_FIT:
+			case YAMM_FIRST_FIT_RND:
+			case YAMM_NEXT_FIT:
+				take = (found == NULL);
+				break;
+			case YAMM_BEST_FIT:
+			case YAMM_BEST_FIT_RND:
+				take = (found == NULL) || (window_hi - window_lo < found_hi - found_lo);
+				break;
+			case YAMM_UNIFORM_FIT:
+				take = (found == NULL) || (window_hi - window_lo > found_hi - found_lo);
+				break;
+			case YAMM_RANDOM_FIT:
+				// Reservoir sampling: each free buffer that fits is equally likely
+				number_of_fits++;
+				take = (rand() % number_of_fits == 0);
+				break;
+			case YAMM_RANDOM_ADDR_FIT: {
+				// Same with a weight of the number of start addresses inside the window
+				uint_64_t window_addrs = (window_hi - (size - 1) - aligned) / alignment + 1;
+				number_of_addrs += window_addrs;
+				take = (generate_rand64() % number_of_addrs < window_addrs);
+				break;
+			}
+			default:
+				return NULL;
+			}
+
+			if (take) {
+				found = temp;
+				found_lo = window_lo;
+				found_hi = window_hi;
+				found_aligned = aligned;
+
+				if ((alloc_mode == YAMM_FIRST_FIT)
+						|| (alloc_mode == YAMM_FIRST_FIT_RND)
+						|| (alloc_mode == YAMM_NEXT_FIT))
+					break;
+			}
+		}
+
+		if ((found) || (!wrap_around))
+			break;
+
+		stop = resumed_at;
+		it = window_begin;
+		wrap_around = 0;
+		YAMM_COUNT(fallbacks);
+	}
+
+	if (!found)
+		return NULL;
+
+	// Number of aligned start addresses after the first one where the buffer still fits
+	uint_64_t slots = (found_hi - (size - 1) - found_aligned) / alignment;
+
+	switch (alloc_mode) {
+	case YAMM_RANDOM_FIT ... YAMM_BEST_FIT_RND:
+	case YAMM_RANDOM_ADDR_FIT:
+		start_addr = found_aligned;
+		if (slots)
+			start_addr += (generate_rand64() % (slots + 1)) * alignment;
+		break;
+	case YAMM_UNIFORM_FIT:
+		start_addr = found_aligned + (slots / 2) * alignment;
+		break;
+	default:
+		start_addr = found_aligned;
+		break;
+	}
+
+	return found;
+}
+
+void yamm_buffer::init_free_buffer() {
+
+	// A slab keeps its free space in the bitmap
+	if ((first) || (is_slab()))
+		return;
+
+	first_free = new yamm_buffer();
+	first_free->start_addr = start_addr;
+	first_free->size = this->size;
+	first_free->end_addr = first_free->start_addr + first_free->size - 1;
+	first_free->is_free = 1;
+	first = first_free;
+	index_free_buffer(first_free);
+}
+
+void yamm_buffer::index_free_buffer(yamm_buffer* free_buffer) {
+
+	// The first free buffer turns this buffer into a container
+	yamm_container_state* state = get_container_state();
+
+	state->free_bytes += free_buffer->size;
+	state->free_by_size[std::make_pair(free_buffer->size,
+			free_buffer->start_addr)] = free_buffer;
+	state->free_by_addr[free_buffer->start_addr] = free_buffer;
+
+	if (state->free_histogram.empty())
+		state->free_histogram.resize(64, 0);
+	state->free_histogram[63 - __builtin_clzll(free_buffer->size)]++;
+
+	if (!state->buddy_blocks.empty())
+		update_buddy_blocks(free_buffer, 1);
+
+	if (!state->tlsf_heads.empty())
+		tlsf_insert(free_buffer);
+
+	if (state->free_space_tree)
+		state->free_space_tree->insert(
+				std::make_pair(
+						std::make_pair(free_buffer->size,
+								free_buffer->start_addr), free_buffer));
+
+	yamm_statistics delta;
+	delta.free_bytes = free_buffer->size;
+	delta.number_of_free_buffers = 1;
+	update_statistics(delta, 0, 1);
+}
+
+void yamm_buffer::unindex_free_buffer(yamm_buffer* free_buffer) {
+
+	yamm_container_state* state = container_state;
+
+	state->free_bytes -= free_buffer->size;
+	state->free_by_size.erase(
+			std::make_pair(free_buffer->size, free_buffer->start_addr));
+	state->free_by_addr.erase(free_buffer->start_addr);
+	state->free_histogram[63 - __builtin_clzll(free_buffer->size)]--;
+
+	if (!state->buddy_blocks.empty())
+		update_buddy_blocks(free_buffer, 0);
+
+	if (!state->tlsf_heads.empty())
+		tlsf_remove(free_buffer);
+
+	if (state->free_space_tree)
+		state->free_space_tree->erase(
+				std::make_pair(free_buffer->size, free_buffer->start_addr));
+
+	yamm_statistics delta;
+	delta.free_bytes = free_buffer->size;
+	delta.number_of_free_buffers = 1;
+	update_statistics(delta, 0, 0);
+}
+
+void yamm_buffer::update_statistics(const yamm_statistics &delta, uint depth,
+		bool increase) {
+
+	yamm_buffer* level = this;
+
+	// Roll the change up to the top level, one recursion level deeper for each parent
+	while (level) {
+
+		yamm_container_state* state = level->get_container_state();
+
+		if (state->level_statistics.size() <= depth)
+			state->level_statistics.resize(depth + 1);
+
+		if (increase)
+			state->level_statistics[depth].add(delta);
+		else {
+			state->level_statistics[depth].subtract(delta);
+
+			// Drop the deepest levels once they don't contain any memory map
+			while ((!state->level_statistics.empty())
+					&& (state->level_statistics.back().number_of_buffers
+							+ state->level_statistics.back().number_of_free_buffers
+							== 0))
+				state->level_statistics.pop_back();
+		}
+
+		level = level->parent;
+		depth++;
+	}
 }
 
 void yamm_buffer::link_in_list(yamm_buffer* free_buffer_prev,
@@ -405,6 +719,10 @@ void yamm_buffer::link_in_list(yamm_buffer* free_buffer_prev,
 			if (first_free == free_buffer_next)
 				first_free = free_buffer_next->next_free;
 
+			// Next fit resumes with the free buffer that follows
+			if (container_state->next_fit_rover == free_buffer_next)
+				container_state->next_fit_rover = free_buffer_next->next_free;
+
 			// The free buffer was removed and replaced by an occupied one
 			delete free_buffer_next;
 			free_buffer_next = NULL;
@@ -422,6 +740,7 @@ void yamm_buffer::link_in_list(yamm_buffer* free_buffer_prev,
 			if (new_buffer->start_addr == this->start_addr)
 				first = new_buffer;
 
+			YAMM_COUNT(splits);
 			number_of_buffers++;
 		}
 	} else {
@@ -457,9 +776,14 @@ void yamm_buffer::link_in_list(yamm_buffer* free_buffer_prev,
 			if (free_buffer_prev->start_addr == this->start_addr)
 				first = free_buffer_prev;
 
+			// Next fit resumes with the free buffer that follows
+			if (container_state->next_fit_rover == free_buffer_next)
+				container_state->next_fit_rover = free_buffer_prev->next_free;
+
 			// We removed the old free buffer and replaced it with a new one, also we added
 			// a new occupied buffer
 			delete free_buffer_next;
+			YAMM_COUNT(splits);
 			number_of_buffers++;
 		} else {			// Case IV: [ new_buffer ]
 			// Link it in the memory between the previous buffer and the allocated buffer
@@ -491,6 +815,7 @@ void yamm_buffer::link_in_list(yamm_buffer* free_buffer_prev,
 				free_buffer_prev->prev_free->next_free = free_buffer_prev;
 
 			// We added a new free buffer and the occupied one
+			YAMM_COUNT(splits);
 			number_of_buffers++;
 			number_of_free_buffers++;
 		}
@@ -501,6 +826,7 @@ void yamm_buffer::merge(yamm_buffer* free_n) {
 	// Check if the previous buffer exists and it's free
 
 	if ((free_n->prev) && (free_n->prev->is_free)) {
+		unindex_free_buffer(free_n->prev);
 		// Update our buffer's size to include the previous one
 		free_n->start_addr = free_n->prev->start_addr;
 		free_n->size = free_n->end_addr - free_n->start_addr + 1;
@@ -517,13 +843,19 @@ void yamm_buffer::merge(yamm_buffer* free_n) {
 			free_n->prev = NULL;
 		}
 
+		// The merged buffer covers the one deleted
+		if (container_state->next_fit_rover == del)
+			container_state->next_fit_rover = free_n;
+
 		delete del;
 		// We removed one free buffer by merging
+		YAMM_COUNT(merges);
 		number_of_free_buffers--;
 	}
 
 	// Check if the next buffer exists and it's free
 	if ((free_n->next) && (free_n->next->is_free)) {
+		unindex_free_buffer(free_n->next);
 		// Update our buffer's size to include the next one
 		free_n->end_addr = free_n->next->end_addr;
 		free_n->size = free_n->end_addr - free_n->start_addr + 1;
@@ -542,8 +874,13 @@ void yamm_buffer::merge(yamm_buffer* free_n) {
 			free_n->next = NULL;
 		}
 
+		// The merged buffer covers the one deleted
+		if (container_state->next_fit_rover == del)
+			container_state->next_fit_rover = free_n;
+
 		delete del;
 		// We removed one free buffer by merging
+		YAMM_COUNT(merges);
 		number_of_free_buffers--;
 	}
 
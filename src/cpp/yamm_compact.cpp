@@ -0,0 +1,93 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_compact
+#define __yamm_compact
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+bool yamm_buffer::is_movable(yamm_buffer* buffer) {
+	return (!buffer->is_free) && (!buffer->is_static) && (!buffer->is_inserted)
+			&& (buffer->first == NULL) && (!buffer->is_slab());
+}
+
+uint yamm_buffer::compact(yamm_relocation_listener* listener,
+		uint max_moves) {
+
+	// The slots of a slab can't move, all of them have the same size
+	if (is_slab())
+		return 0;
+
+	init_free_buffer();
+
+	uint number_of_moves = 0;
+	yamm_buffer* free_buffer = first_free;
+
+	while (free_buffer && ((max_moves == 0) || (number_of_moves < max_moves))) {
+
+		// Free buffers are merged so the next buffer is occupied
+		yamm_buffer* buffer = free_buffer->next;
+		if (!buffer)
+			break;
+
+		uint_64_t new_start_addr = free_buffer->start_addr;
+		if (buffer->start_addr_alignment_mask != YAMM_NO_MASK)
+			new_start_addr += (0 - new_start_addr)
+					& buffer->start_addr_alignment_mask;
+		else
+			new_start_addr += (buffer->start_addr_alignment
+					- new_start_addr % buffer->start_addr_alignment)
+					% buffer->start_addr_alignment;
+
+		// The free space before the buffer is too small for its alignment
+		if ((!is_movable(buffer)) || (new_start_addr >= buffer->start_addr)) {
+			free_buffer = free_buffer->next_free;
+			continue;
+		}
+
+		uint_64_t old_start_addr = buffer->start_addr;
+
+		// The free space before and after the buffer is merged, the buffer is placed
+		// at the start of it and the rest is still free
+		yamm_buffer* merged_free = release(buffer);
+
+		buffer->next = NULL;
+		buffer->prev = NULL;
+		buffer->next_free = NULL;
+		buffer->prev_free = NULL;
+		buffer->start_addr = new_start_addr;
+		buffer->end_addr = new_start_addr + buffer->size - 1;
+
+		add(buffer, merged_free);
+		number_of_moves++;
+
+		notify(YAMM_EVENT_MOVE, buffer, YAMM_NO_MODE, old_start_addr,
+				old_start_addr + buffer->size - 1);
+
+		if (listener)
+			listener->buffer_moved(buffer, old_start_addr);
+
+		// The buffer ends before its old end address so it's followed by free space
+		free_buffer = buffer->next;
+	}
+
+	return number_of_moves;
+}
+
+#endif // __yamm_compact
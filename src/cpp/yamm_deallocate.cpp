@@ -56,6 +56,17 @@ bool yamm_buffer::deallocate(yamm_buffer* del) {
 		return 0;
 	}
 
+	// Slots aren't linked, they are found in the bitmap of the slab
+	if (is_slab()) {
+		if ((del->first != NULL) || (del->is_slab())) {
+			if (!disable_info)
+				fprintf(stderr,
+						"[YAMM_INF] Buffer has other buffers inside!\n\t in %s at line %d\n",
+						__FILE__, __LINE__);
+		}
+		return deallocate_slot(del);
+	}
+
 	if ((del->next == NULL) && (del->prev == NULL) && (first != del)) {
 		fprintf(stderr,
 				"[YAMM_WRN] Buffer is not linked anywhere!\n\t in %s at line %d\n",
@@ -63,14 +74,30 @@ bool yamm_buffer::deallocate(yamm_buffer* del) {
 		return 0;
 	}
 
-	if (del->first != NULL) {
+	if ((del->first != NULL) || (del->is_slab())) {
 		if (!disable_info)
 			fprintf(stderr,
 					"[YAMM_INF] Buffer has other buffers inside!\n\t in %s at line %d\n",
 					__FILE__, __LINE__);
 	}
 
-	yamm_buffer* temp;
+#ifdef YAMM_DEBUG_CHECKS
+	check_consistency_around(release(del));
+#else
+	release(del);
+#endif
+
+	notify(YAMM_EVENT_DEALLOCATE, del, YAMM_NO_MODE, del->start_addr,
+			del->end_addr);
+
+	YAMM_COUNT(deallocations);
+	delete del;
+
+	return 1;
+
+}
+
+yamm_buffer* yamm_buffer::release(yamm_buffer* del) {
 
 	// Create a new buffer to replace the deallocated one
 	yamm_buffer* new_free_buffer = new yamm_buffer(del->start_addr, del->size);
@@ -86,43 +113,46 @@ bool yamm_buffer::deallocate(yamm_buffer* del) {
 	number_of_buffers--;
 	number_of_free_buffers++;
 
+	yamm_statistics delta;
+	delta.used_bytes = del->size;
+	delta.number_of_buffers = 1;
+	update_statistics(delta, 0, 0);
+
+	// The memory maps contained by the deallocated buffer are deleted with it
+	// (starting with the deepest one so the emptied levels are dropped in order)
+	for (uint level = del->get_number_of_levels(); level > 0; --level)
+		update_statistics(del->container_state->level_statistics[level - 1],
+				level, 0);
+
 	// Merge adjacent free buffers
 	merge(new_free_buffer);
+	index_free_buffer(new_free_buffer);
 
 	if (new_free_buffer->start_addr == start_addr)
 		first = new_free_buffer;
 
-	// Link the new buffer in the lists
-	temp = new_free_buffer;
-
-	if (temp->next) {
-		temp = temp->next;
-		while ((!temp->is_free) && (temp->next))
-			temp = temp->next;
-		if (temp->is_free) {
-			temp->prev_free = new_free_buffer;
-			new_free_buffer->next_free = temp;
-		}
-	}
+	// Link the new buffer in the free list between its closest free neighbors
+	std::map<uint_64_t, yamm_buffer*>::iterator it = container_state->free_by_addr.find(
+			new_free_buffer->start_addr);
+	std::map<uint_64_t, yamm_buffer*>::iterator next_it = it;
+	++next_it;
 
-	temp = new_free_buffer;
-
-	if (temp->prev) {
-		temp = temp->prev;
-		while ((!temp->is_free) && (temp->prev))
-			temp = temp->prev;
-		if (temp->is_free) {
-			temp->next_free = new_free_buffer;
-			new_free_buffer->prev_free = temp;
-		} else
-			first_free = new_free_buffer;
+	if (next_it != container_state->free_by_addr.end()) {
+		next_it->second->prev_free = new_free_buffer;
+		new_free_buffer->next_free = next_it->second;
 	} else
+		new_free_buffer->next_free = NULL;
+
+	if (it != container_state->free_by_addr.begin()) {
+		--it;
+		it->second->next_free = new_free_buffer;
+		new_free_buffer->prev_free = it->second;
+	} else {
+		new_free_buffer->prev_free = NULL;
 		first_free = new_free_buffer;
+	}
 
-	delete del;
-
-	return 1;
-
+	return new_free_buffer;
 }
 
 bool yamm_buffer::deallocate_by_addr(uint_64_t addr) {
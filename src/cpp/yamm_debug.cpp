@@ -19,6 +19,7 @@
 #define __yamm_debug
 
 #include "yamm.h"
+#include <algorithm>
 
 using namespace yamm_ns;
 
@@ -138,6 +139,18 @@ std::string yamm_buffer::sprint(bool recursive = 0, int indentation = 0) {
 		}
 	}
 
+	if (recursive == 1 && is_slab()) {
+
+		for (int i = 0; i < indentation; ++i)
+			indent = indent + "    ";
+
+		// Only the occupied slots
+		for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots; ++slot)
+			if (container_state->slab_slots[slot])
+				rez = rez + "\n" + indent
+						+ container_state->slab_slots[slot]->sprint(1, indentation + 1);
+	}
+
 	return rez;
 }
 
@@ -166,41 +179,272 @@ void yamm_buffer::print_free(FILE* fp) {
 }
 
 double yamm_buffer::get_fragmentation() {
-	yamm_buffer* temp;
-	temp = first;
-	double free_buffers = 0;
-	double buffers = 0;
-	double frag;
-	while (temp) {
-		if (temp->is_free)
-			free_buffers++;
-		buffers++;
-		temp = temp->next;
-	}
-	frag = free_buffers / buffers * 100;
+
+	// Nothing was allocated inside yet
+	if ((!first) && (!is_slab()))
+		return 0;
+
+	// Both counters are kept up to date by add(), merge() and deallocate()
+	double free_buffers = number_of_free_buffers;
+	double buffers = number_of_buffers + number_of_free_buffers;
+	double frag = free_buffers / buffers * 100;
 	return frag;
 }
 
 double yamm_buffer::get_usage_statistics() {
-	yamm_buffer* temp;
-	temp = first;
-	uint_64_t size_free_buffers = 0;
-	uint_64_t mem_size = 0;
-	double usage_stats;
 
-	while (temp) {
-		if (temp->is_free)
-			size_free_buffers = size_free_buffers + temp->size;
-		mem_size = mem_size + temp->size;
-		temp = temp->next;
-	}
+	// Nothing was allocated inside yet
+	if ((!first) && (!is_slab()))
+		return 0;
 
-	usage_stats = 100 - (1.0 * size_free_buffers / mem_size * 100);
+	// free_bytes is kept up to date by add(), merge() and deallocate()
+	double usage_stats = 100 - (1.0 * container_state->free_bytes / size * 100);
 	return usage_stats;
 
 }
 
+yamm_statistics yamm_buffer::get_level_statistics(uint level) {
+
+	if (level < get_number_of_levels())
+		return container_state->level_statistics[level];
+
+	return yamm_statistics();
+}
+
+yamm_statistics yamm_buffer::get_tree_statistics() {
+
+	yamm_statistics result;
+
+	// Each recursion level is already summed up, no need to go through the buffers
+	for (uint level = 0; level < get_number_of_levels(); ++level)
+		result.add(container_state->level_statistics[level]);
+
+	return result;
+}
+
+std::vector<uint> yamm_buffer::get_free_histogram() {
+
+	std::vector<uint> histogram(64, 0);
+
+	// Each free slot is a free buffer
+	if (is_slab()) {
+		histogram[63 - __builtin_clzll(container_state->slab_slot_size)] =
+				number_of_free_buffers;
+		return histogram;
+	}
+
+	// Nothing was allocated inside yet so there is one free buffer of the whole size
+	if (!first) {
+		if (size)
+			histogram[63 - __builtin_clzll(size)] = 1;
+		return histogram;
+	}
+
+	if (!container_state->free_histogram.empty())
+		histogram = container_state->free_histogram;
+
+	return histogram;
+}
+
+double yamm_buffer::get_external_fragmentation() {
+
+	uint_64_t free_size = get_free_bytes();
+
+	if (free_size == 0)
+		return 0;
+
+	return 100 - (1.0 * get_largest_free_extent() / free_size * 100);
+}
+
+uint_64_t yamm_buffer::largest_allocatable(uint_64_t alignment,
+		uint_64_t granularity) {
+
+	if ((alignment == 0) || (granularity == 0)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Alignment and granularity can't be 0!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	uint_64_t alignment_mask = compute_mask(alignment);
+
+	// A slot, if one is free and the alignment works for the slots
+	if (is_slab()) {
+		if ((number_of_free_buffers == 0) || (start_addr % alignment)
+				|| (container_state->slab_slot_size % alignment))
+			return 0;
+		return container_state->slab_slot_size
+				- container_state->slab_slot_size % granularity;
+	}
+
+	// Nothing was allocated inside yet, check the whole buffer
+	if (!first) {
+		yamm_buffer whole(start_addr, size);
+		uint_64_t aligned_size = compute_size_with_align(alignment, alignment_mask, &whole);
+		return aligned_size - aligned_size % granularity;
+	}
+
+	uint_64_t best = 0;
+
+	// Go through the free buffers from the largest one, a free buffer can't hold
+	// more than its size so stop when it isn't larger than the best result
+	std::map<std::pair<uint_64_t, uint_64_t>, yamm_buffer*>::reverse_iterator it;
+	for (it = container_state->free_by_size.rbegin();
+			it != container_state->free_by_size.rend(); ++it) {
+
+		if (it->first.first <= best)
+			break;
+
+		uint_64_t aligned_size = compute_size_with_align(alignment, alignment_mask, it->second);
+		aligned_size = aligned_size - aligned_size % granularity;
+
+		if (aligned_size > best)
+			best = aligned_size;
+	}
+
+	return best;
+}
+
+void yamm_buffer::compute_level_statistics(
+		std::vector<yamm_statistics> &levels, uint depth) {
+
+	if ((!first) && (!is_slab()))
+		return;
+
+	if (levels.size() <= depth)
+		levels.resize(depth + 1);
+
+	if (is_slab()) {
+
+		uint_64_t occupied = 0;
+
+		for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots; ++slot) {
+			if (!container_state->slab_slots[slot])
+				continue;
+			occupied++;
+			container_state->slab_slots[slot]->compute_level_statistics(levels, depth + 1);
+		}
+
+		// Each free slot is a free buffer, the bytes after the last slot are free too
+		levels[depth].used_bytes += occupied * container_state->slab_slot_size;
+		levels[depth].free_bytes += size - occupied * container_state->slab_slot_size;
+		levels[depth].number_of_buffers += occupied;
+		levels[depth].number_of_free_buffers +=
+				container_state->slab_number_of_slots - occupied;
+		return;
+	}
+
+	for (yamm_buffer* temp = first; temp; temp = temp->next) {
+		if (temp->is_free) {
+			levels[depth].free_bytes += temp->size;
+			levels[depth].number_of_free_buffers++;
+		} else {
+			levels[depth].used_bytes += temp->size;
+			levels[depth].number_of_buffers++;
+			temp->compute_level_statistics(levels, depth + 1);
+		}
+	}
+}
+
 bool yamm_buffer::check_address_space_consistency() {
+
+	// The statistics of each recursion level are updated incrementally, sum them up again
+	std::vector<yamm_statistics> levels;
+	compute_level_statistics(levels, 0);
+
+	while ((!levels.empty())
+			&& (levels.back().number_of_buffers
+					+ levels.back().number_of_free_buffers == 0))
+		levels.pop_back();
+
+	for (uint level = 0; (level < levels.size()) || (level < get_number_of_levels());
+			++level) {
+
+		yamm_statistics expected =
+				(level < levels.size()) ? levels[level] : yamm_statistics();
+		yamm_statistics actual = get_level_statistics(level);
+
+		if ((expected.used_bytes != actual.used_bytes)
+				|| (expected.free_bytes != actual.free_bytes)
+				|| (expected.number_of_buffers != actual.number_of_buffers)
+				|| (expected.number_of_free_buffers
+						!= actual.number_of_free_buffers)) {
+			fprintf(stderr,
+					"[YAMM_ERR] Level %u of buffer [%llu, %llu] counts %llu used, %llu free bytes, %llu used, %llu free buffers instead of %llu, %llu, %llu, %llu !\n\t in %s at line %d\n",
+					level, start_addr, end_addr, actual.used_bytes,
+					actual.free_bytes, actual.number_of_buffers,
+					actual.number_of_free_buffers, expected.used_bytes,
+					expected.free_bytes, expected.number_of_buffers,
+					expected.number_of_free_buffers, __FILE__, __LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+	}
+
+	// A slab has no list, the bitmap has to match the occupied slots
+	if (is_slab()) {
+
+		uint occupied = 0;
+
+		for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots; ++slot) {
+
+			yamm_buffer* it = container_state->slab_slots[slot];
+			bool bit = (container_state->slab_bitmap[slot >> 6] >> (slot & 63)) & 1;
+
+			if ((it != NULL) != bit) {
+				fprintf(stderr,
+						"[YAMM_ERR] Slot %llu of slab [%llu, %llu] doesn't match the bitmap !\n\t in %s at line %d\n",
+						slot, start_addr, end_addr, __FILE__, __LINE__);
+				exit(YAMM_EXIT_CODE);
+			}
+
+			if (!it)
+				continue;
+
+			occupied++;
+
+			if ((it->start_addr != start_addr + slot * container_state->slab_slot_size)
+					|| (it->size != container_state->slab_slot_size)) {
+				fprintf(stderr,
+						"[YAMM_ERR] Buffer [%llu, %llu] is not slot %llu !\n\t in %s at line %d\n",
+						it->start_addr, it->end_addr, slot, __FILE__, __LINE__);
+				exit(YAMM_EXIT_CODE);
+			}
+
+			if ((it->first) || (it->is_slab()))
+				it->check_address_space_consistency();
+		}
+
+		if (occupied != number_of_buffers) {
+			fprintf(stderr,
+					"[YAMM_ERR] Slab [%llu, %llu] has %u occupied slots instead of %u !\n\t in %s at line %d\n",
+					start_addr, end_addr, occupied, number_of_buffers, __FILE__,
+					__LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+
+		// The bytes after the last slot are free too
+		if ((number_of_free_buffers
+				!= container_state->slab_number_of_slots - occupied)
+				|| (container_state->free_bytes
+						!= size - occupied * container_state->slab_slot_size)) {
+			fprintf(stderr,
+					"[YAMM_ERR] Slab [%llu, %llu] counts %u free slots and %llu free bytes !\n\t in %s at line %d\n",
+					start_addr, end_addr, number_of_free_buffers,
+					container_state->free_bytes,
+					__FILE__, __LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+
+		return 1;
+	}
+
+	// What the counters and the indexes of the free buffers should hold
+	uint used = 0;
+	uint free = 0;
+	uint_64_t free_size = 0;
+	std::vector<uint> histogram(64, 0);
+
 	yamm_buffer* temp;
 	temp = first;
 	while (temp) {
@@ -250,12 +494,34 @@ bool yamm_buffer::check_address_space_consistency() {
 			exit(YAMM_EXIT_CODE);
 		}
 
+		// Each free buffer is indexed by address and by size
+		if (temp->is_free) {
+
+			std::map<uint_64_t, yamm_buffer*>::iterator by_addr =
+					container_state->free_by_addr.find(temp->start_addr);
+			std::map<std::pair<uint_64_t, uint_64_t>, yamm_buffer*>::iterator by_size =
+					container_state->free_by_size.find(
+							std::make_pair(temp->size, temp->start_addr));
+
+			if ((by_addr == container_state->free_by_addr.end())
+					|| (by_addr->second != temp)
+					|| (by_size == container_state->free_by_size.end())
+					|| (by_size->second != temp)) {
+				fprintf(stderr,
+						"[YAMM_ERR] Free buffer [%llu, %llu] is not indexed !\n\t in %s at line %d\n",
+						temp->start_addr, temp->end_addr, __FILE__, __LINE__);
+				exit(YAMM_EXIT_CODE);
+			}
+
+			free++;
+			free_size += temp->size;
+			histogram[63 - __builtin_clzll(temp->size)]++;
+		} else
+			used++;
+
 		// If current buffer contains other buffers
 		if (temp->first) {
 
-			// Check recursively
-			temp->first->check_address_space_consistency();
-
 			// Check that the first child starts at buffer start address
 			if (temp->first->start_addr != temp->start_addr) {
 				fprintf(stderr,
@@ -282,8 +548,150 @@ bool yamm_buffer::check_address_space_consistency() {
 
 		}
 
+		// Check recursively the memory map inside
+		if ((temp->first) || (temp->is_slab()))
+			temp->check_address_space_consistency();
+
 		temp = temp->next;
 	}
+
+	// Nothing was allocated inside yet
+	if (!first)
+		return 1;
+
+	if ((used != number_of_buffers) || (free != number_of_free_buffers)
+			|| (free_size != container_state->free_bytes)) {
+		fprintf(stderr,
+				"[YAMM_ERR] Buffer [%llu, %llu] counts %u occupied and %u free buffers, %llu free bytes instead of %u, %u, %llu !\n\t in %s at line %d\n",
+				start_addr, end_addr, number_of_buffers, number_of_free_buffers,
+				container_state->free_bytes, used, free, free_size, __FILE__, __LINE__);
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// No stale entries in the indexes
+	if ((container_state->free_by_addr.size() != free)
+			|| (container_state->free_by_size.size() != free)
+			|| (container_state->free_histogram != histogram)) {
+		fprintf(stderr,
+				"[YAMM_ERR] Buffer [%llu, %llu] indexes %lu free buffers by address and %lu by size instead of %u, or the histogram is wrong !\n\t in %s at line %d\n",
+				start_addr, end_addr,
+				(unsigned long) container_state->free_by_addr.size(),
+				(unsigned long) container_state->free_by_size.size(), free,
+				__FILE__, __LINE__);
+		exit(YAMM_EXIT_CODE);
+	}
+
+	return 1;
+}
+
+bool yamm_buffer::check_local_consistency(yamm_buffer* buffer) {
+
+	// Correct and strictly positive size
+	if ((buffer->size < 1)
+			|| ((buffer->end_addr - buffer->start_addr + 1) != (buffer->size))) {
+		fprintf(stderr,
+				"[YAMM_ERR] Size mismatch: %llu for [%llu, %llu] !\n\t in %s at line %d\n",
+				buffer->size, buffer->start_addr, buffer->end_addr, __FILE__,
+				__LINE__);
+		exit(YAMM_EXIT_CODE);
+	}
+
+	if (buffer->prev) {
+
+		// Continuity and links to the left
+		if ((buffer->prev->end_addr + 1 != buffer->start_addr)
+				|| (buffer->prev->next != buffer)) {
+			fprintf(stderr,
+					"[YAMM_ERR] Bad link between [%llu, %llu] and previous [%llu, %llu] !\n\t in %s at line %d\n",
+					buffer->start_addr, buffer->end_addr,
+					buffer->prev->start_addr, buffer->prev->end_addr, __FILE__,
+					__LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+	} else if ((first != buffer) || (buffer->start_addr != start_addr)) {
+		fprintf(stderr,
+				"[YAMM_ERR] Buffer [%llu, %llu] has no previous buffer but it is not the first one !\n\t in %s at line %d\n",
+				buffer->start_addr, buffer->end_addr, __FILE__, __LINE__);
+		exit(YAMM_EXIT_CODE);
+	}
+
+	if (buffer->next) {
+
+		// Continuity and links to the right
+		if ((buffer->end_addr + 1 != buffer->next->start_addr)
+				|| (buffer->next->prev != buffer)) {
+			fprintf(stderr,
+					"[YAMM_ERR] Bad link between [%llu, %llu] and next [%llu, %llu] !\n\t in %s at line %d\n",
+					buffer->start_addr, buffer->end_addr,
+					buffer->next->start_addr, buffer->next->end_addr, __FILE__,
+					__LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+	} else if (buffer->end_addr != end_addr) {
+		fprintf(stderr,
+				"[YAMM_ERR] Last buffer ends at %llu instead of %llu !\n\t in %s at line %d\n",
+				buffer->end_addr, end_addr, __FILE__, __LINE__);
+		exit(YAMM_EXIT_CODE);
+	}
+
+	if (!buffer->is_free)
+		return 1;
+
+	// Free buffers are merged
+	if (((buffer->prev) && (buffer->prev->is_free))
+			|| ((buffer->next) && (buffer->next->is_free))) {
+		fprintf(stderr,
+				"[YAMM_ERR] Free buffer [%llu, %llu] is not merged with its neighbors !\n\t in %s at line %d\n",
+				buffer->start_addr, buffer->end_addr, __FILE__, __LINE__);
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// Free list links to the left
+	if (buffer->prev_free) {
+		if ((!buffer->prev_free->is_free)
+				|| (buffer->prev_free->next_free != buffer)
+				|| (buffer->prev_free->end_addr >= buffer->start_addr)) {
+			fprintf(stderr,
+					"[YAMM_ERR] Bad free link between [%llu, %llu] and previous free [%llu, %llu] !\n\t in %s at line %d\n",
+					buffer->start_addr, buffer->end_addr,
+					buffer->prev_free->start_addr, buffer->prev_free->end_addr,
+					__FILE__, __LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+	} else if (first_free != buffer) {
+		fprintf(stderr,
+				"[YAMM_ERR] Free buffer [%llu, %llu] has no previous free buffer but it is not the first free one !\n\t in %s at line %d\n",
+				buffer->start_addr, buffer->end_addr, __FILE__, __LINE__);
+		exit(YAMM_EXIT_CODE);
+	}
+
+	// Free list links to the right
+	if (buffer->next_free) {
+		if ((!buffer->next_free->is_free)
+				|| (buffer->next_free->prev_free != buffer)
+				|| (buffer->next_free->start_addr <= buffer->end_addr)) {
+			fprintf(stderr,
+					"[YAMM_ERR] Bad free link between [%llu, %llu] and next free [%llu, %llu] !\n\t in %s at line %d\n",
+					buffer->start_addr, buffer->end_addr,
+					buffer->next_free->start_addr, buffer->next_free->end_addr,
+					__FILE__, __LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+	}
+
+	return 1;
+}
+
+bool yamm_buffer::check_consistency_around(yamm_buffer* buffer) {
+
+	check_local_consistency(buffer);
+
+	if (buffer->prev)
+		check_local_consistency(buffer->prev);
+
+	if (buffer->next)
+		check_local_consistency(buffer->next);
+
 	return 1;
 }
 
@@ -294,14 +702,90 @@ bool yamm_buffer::check_address_space_consistency() {
 bool yamm_buffer::access_overlaps(yamm_access* access) {
 	yamm_buffer* temp = internal_get_buffer(access->start_addr);
 
+	return (find_overlapping_buffer(temp, access->start_addr,
+			access->end_addr) != NULL);
+}
+
+yamm_buffer* yamm_buffer::find_overlapping_buffer(yamm_buffer* temp,
+		uint_64_t start_addr, uint_64_t end_addr) {
+
+	// Look for an occupied slot in the bitmap
+	if (is_slab()) {
+		if ((start_addr > this->end_addr) || (end_addr < this->start_addr))
+			return NULL;
+
+		start_addr = std::max(start_addr, this->start_addr);
+		uint_64_t first_slot = (start_addr - this->start_addr)
+				/ container_state->slab_slot_size;
+		uint_64_t last_slot = std::min(container_state->slab_number_of_slots - 1,
+				(end_addr - this->start_addr) / container_state->slab_slot_size);
+
+		if (first_slot > last_slot)
+			return NULL;
+
+		uint_64_t slot = find_slot(first_slot, last_slot, 0);
+		return (slot == YAMM_NO_SLOT) ? NULL : container_state->slab_slots[slot];
+	}
+
 	// Search for occupied buffers in the range specified by access
-	while ((temp) &&(temp->start_addr < access->end_addr)) {
+	while ((temp) && (temp->start_addr <= end_addr)) {
 		if (temp->is_free == 0)
-			return 1;
+			return temp;
 		temp = temp->next;
 	}
 
-	return 0;
+	return NULL;
+}
+
+std::vector<bool> yamm_buffer::access_overlaps(
+		std::vector<yamm_access> &accesses,
+		std::vector<yamm_buffer*> &overlapping_buffers) {
+
+	std::vector<bool> overlaps(accesses.size(), 0);
+	overlapping_buffers.assign(accesses.size(), NULL);
+
+	// (start address, position) of the accesses, sorted by start address
+	std::vector<std::pair<uint_64_t, uint_64_t> > order;
+	order.reserve(accesses.size());
+
+	for (uint_64_t i = 0; i < accesses.size(); ++i)
+		order.push_back(std::make_pair(accesses[i].start_addr, i));
+
+	std::sort(order.begin(), order.end());
+
+	// Nothing was allocated inside yet, so nothing can overlap
+	if ((!first) && (!is_slab()))
+		return overlaps;
+
+	// One pass over the memory map: the buffer that contains the start address
+	// of an access is searched from the one found for the previous access.
+	// A slab looks for each access in its bitmap instead.
+	yamm_buffer* temp = first;
+
+	for (uint_64_t i = 0; i < order.size(); ++i) {
+
+		yamm_access &access = accesses[order[i].second];
+
+		// Only the part of the access inside the memory can overlap a buffer
+		if ((access.end_addr < access.start_addr)
+				|| (access.start_addr > this->end_addr)
+				|| (access.end_addr < this->start_addr))
+			continue;
+
+		uint_64_t start = std::max(access.start_addr, this->start_addr);
+		uint_64_t end = std::min(access.end_addr, this->end_addr);
+
+		while ((temp) && (temp->next) && (temp->end_addr < start))
+			temp = temp->next;
+
+		yamm_buffer* buffer = find_overlapping_buffer(temp, start, end);
+		if (buffer) {
+			overlaps[order[i].second] = 1;
+			overlapping_buffers[order[i].second] = buffer;
+		}
+	}
+
+	return overlaps;
 }
 
 #endif // __yamm_debug
@@ -0,0 +1,202 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_diff
+#define __yamm_diff
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+yamm_buffer* yamm_buffer::first_occupied() {
+
+	if (is_slab()) {
+		uint_64_t slot = container_state->slab_number_of_slots ?
+				find_slot(0, container_state->slab_number_of_slots - 1, 0) : YAMM_NO_SLOT;
+		return (slot == YAMM_NO_SLOT) ? NULL : container_state->slab_slots[slot];
+	}
+
+	yamm_buffer* temp = first;
+	while ((temp) && (temp->is_free))
+		temp = temp->next;
+
+	return temp;
+}
+
+yamm_buffer* yamm_buffer::next_occupied(yamm_buffer* buffer) {
+
+	if (is_slab()) {
+		uint_64_t slot = (buffer->start_addr - start_addr)
+				/ container_state->slab_slot_size + 1;
+		if (slot >= container_state->slab_number_of_slots)
+			return NULL;
+		slot = find_slot(slot, container_state->slab_number_of_slots - 1, 0);
+		return (slot == YAMM_NO_SLOT) ? NULL : container_state->slab_slots[slot];
+	}
+
+	yamm_buffer* temp = buffer->next;
+	while ((temp) && (temp->is_free))
+		temp = temp->next;
+
+	return temp;
+}
+
+yamm_buffer* yamm_buffer::snapshot() {
+
+	yamm_buffer* copy = new yamm_buffer(this);
+
+	// The counters are rebuilt by the buffers added below
+	copy->number_of_buffers = 0;
+	copy->number_of_free_buffers = 1;
+
+	if (is_slab()) {
+		copy->make_slab(container_state->slab_slot_size);
+		for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots; ++slot)
+			if (container_state->slab_slots[slot])
+				copy->occupy_slot(container_state->slab_slots[slot]->snapshot(), slot);
+		return copy;
+	}
+
+	if (!first)
+		return copy;
+
+	copy->init_free_buffer();
+
+	// The buffers are added in address order so each one goes in the free buffer at the end
+	yamm_buffer* free_buffer = copy->first;
+
+	for (yamm_buffer* temp = first_occupied(); temp; temp = next_occupied(temp)) {
+		yamm_buffer* buffer = temp->snapshot();
+		copy->add(buffer, free_buffer);
+		free_buffer = buffer->next;
+	}
+
+	return copy;
+}
+
+std::vector<yamm_diff> yamm_buffer::diff(yamm_buffer* old_map,
+		yamm_buffer* new_map) {
+
+	std::vector<yamm_diff> differences;
+
+	if ((old_map) && (new_map))
+		diff_level(old_map, new_map, 0, differences);
+
+	return differences;
+}
+
+void yamm_buffer::diff_level(yamm_buffer* old_map, yamm_buffer* new_map,
+		unsigned int level, std::vector<yamm_diff> &differences) {
+
+	// Positions of the buffers removed and added in this memory map, to find the moved ones
+	std::vector<uint_64_t> removed;
+	std::vector<uint_64_t> added;
+
+	yamm_buffer* old_buffer = old_map->first_occupied();
+	yamm_buffer* new_buffer = new_map->first_occupied();
+
+	// Both memory maps are sorted by address so they are walked together
+	while ((old_buffer) || (new_buffer)) {
+
+		if ((new_buffer == NULL)
+				|| ((old_buffer)
+						&& (old_buffer->start_addr < new_buffer->start_addr))) {
+			removed.push_back(differences.size());
+			differences.push_back(
+					yamm_diff(YAMM_DIFF_REMOVED, level, old_buffer, NULL,
+							old_buffer->start_addr, old_buffer->size, 0, 0,
+							old_buffer->name));
+			old_buffer = old_map->next_occupied(old_buffer);
+			continue;
+		}
+
+		if ((old_buffer == NULL)
+				|| (new_buffer->start_addr < old_buffer->start_addr)
+				|| (new_buffer->name != old_buffer->name)) {
+			added.push_back(differences.size());
+			differences.push_back(
+					yamm_diff(YAMM_DIFF_ADDED, level, NULL, new_buffer, 0, 0,
+							new_buffer->start_addr, new_buffer->size,
+							new_buffer->name));
+			new_buffer = new_map->next_occupied(new_buffer);
+			continue;
+		}
+
+		// Same start address and name, it's the same buffer
+		if (old_buffer->size != new_buffer->size)
+			differences.push_back(
+					yamm_diff(YAMM_DIFF_RESIZED, level, old_buffer, new_buffer,
+							old_buffer->start_addr, old_buffer->size,
+							new_buffer->start_addr, new_buffer->size,
+							new_buffer->name));
+
+		if (old_buffer->is_static != new_buffer->is_static)
+			differences.push_back(
+					yamm_diff(YAMM_DIFF_STATIC_CHANGED, level, old_buffer,
+							new_buffer, old_buffer->start_addr, old_buffer->size,
+							new_buffer->start_addr, new_buffer->size,
+							new_buffer->name));
+
+		diff_level(old_buffer, new_buffer, level + 1, differences);
+
+		old_buffer = old_map->next_occupied(old_buffer);
+		new_buffer = new_map->next_occupied(new_buffer);
+	}
+
+	if ((removed.empty()) || (added.empty()))
+		return;
+
+	// A named buffer that was removed and added again moved, the first removal with
+	// a name is paired with the first addition with the same name
+	std::multimap<std::string, uint_64_t> removed_by_name;
+	for (uint_64_t i = 0; i < removed.size(); ++i)
+		if (!differences[removed[i]].name.empty())
+			removed_by_name.insert(
+					std::make_pair(differences[removed[i]].name, removed[i]));
+
+	std::vector<bool> is_moved(differences.size(), 0);
+
+	for (uint_64_t i = 0; (i < added.size()) && (!removed_by_name.empty());
+			++i) {
+
+		std::multimap<std::string, uint_64_t>::iterator it =
+				removed_by_name.lower_bound(differences[added[i]].name);
+		if ((it == removed_by_name.end())
+				|| (it->first != differences[added[i]].name))
+			continue;
+
+		yamm_diff &moved = differences[added[i]];
+		yamm_diff &removal = differences[it->second];
+
+		moved.kind = YAMM_DIFF_MOVED;
+		moved.old_buffer = removal.old_buffer;
+		moved.old_start_addr = removal.old_start_addr;
+		moved.old_size = removal.old_size;
+		is_moved[it->second] = 1;
+
+		removed_by_name.erase(it);
+	}
+
+	// Drop the removals that became moves, the differences of the nested memory maps stay
+	uint_64_t kept = removed[0];
+	for (uint_64_t i = removed[0]; i < differences.size(); ++i)
+		if (!is_moved[i])
+			differences[kept++] = differences[i];
+	differences.erase(differences.begin() + kept, differences.end());
+}
+
+#endif // __yamm_diff
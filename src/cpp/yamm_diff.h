@@ -0,0 +1,85 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_diff_h
+#define __yamm_diff_h
+
+#include <string>
+
+namespace yamm_ns {
+
+#ifndef uint_64_t
+typedef unsigned long long int uint_64_t;
+#endif
+
+class yamm_buffer;
+
+/** Buffer is only in the new memory map */
+#define YAMM_DIFF_ADDED 0
+/** Buffer is only in the old memory map */
+#define YAMM_DIFF_REMOVED 1
+/** Buffer starts at the same address with another size */
+#define YAMM_DIFF_RESIZED 2
+/** Buffer with the same name is at another address */
+#define YAMM_DIFF_MOVED 3
+/** Buffer was allocated in static mode in only one of the memory maps */
+#define YAMM_DIFF_STATIC_CHANGED 4
+
+/**
+ * Class that describes a difference between two memory maps
+ */
+class yamm_diff {
+public:
+
+	/** Kind of difference, one of YAMM_DIFF_* */
+	int kind;
+	/** Recursion level of the memory map, 0 is the one that was compared */
+	unsigned int level;
+	/** Buffer in the old memory map, NULL if it was added */
+	yamm_buffer* old_buffer;
+	/** Buffer in the new memory map, NULL if it was removed */
+	yamm_buffer* new_buffer;
+	/** Start address in the old memory map, 0 if it was added */
+	uint_64_t old_start_addr;
+	/** Size in the old memory map, 0 if it was added */
+	uint_64_t old_size;
+	/** Start address in the new memory map, 0 if it was removed */
+	uint_64_t new_start_addr;
+	/** Size in the new memory map, 0 if it was removed */
+	uint_64_t new_size;
+	/** Name of the buffer */
+	std::string name;
+
+	yamm_diff(int kind, unsigned int level, yamm_buffer* old_buffer,
+			yamm_buffer* new_buffer, uint_64_t old_start_addr,
+			uint_64_t old_size, uint_64_t new_start_addr, uint_64_t new_size,
+			std::string name) {
+		this->kind = kind;
+		this->level = level;
+		this->old_buffer = old_buffer;
+		this->new_buffer = new_buffer;
+		this->old_start_addr = old_start_addr;
+		this->old_size = old_size;
+		this->new_start_addr = new_start_addr;
+		this->new_size = new_size;
+		this->name = name;
+	}
+
+};
+
+}
+#endif // __yamm_diff_h
@@ -0,0 +1,199 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_engine_h
+#define __yamm_engine_h
+
+#include "yamm_extent_map.h"
+
+namespace yamm_ns {
+
+/**
+ * Memory allocator with the allocation policy, address type and random generator
+ * fixed at compile time. Every call is resolved statically so the compiler can inline
+ * the search and placement of the policy in allocate().
+ *
+ * Buffers are identified by the extent index returned by allocate() and insert().
+ * The yamm class remains the allocator with runtime allocation modes and recursion,
+ * and the only one with YAMM_BUDDY_FIT, YAMM_TLSF_FIT and YAMM_NEXT_FIT, which keep
+ * state between allocations that the stateless policies don't have.
+ *
+ * AddrT can be uint_32_t for memories up to 4GB, which halves the address fields of
+ * each record, or uint_128_t for memories of 2^64 bytes and more.
+ *
+ * Example:
+ *   yamm_engine<uint_64_t, yamm_best_fit_policy> engine;
+ *   engine.build(0x10000);
+ *   uint_32_t buffer = engine.allocate(0x100, 0x10);
+ */
+template<class AddrT, class Policy = yamm_first_fit_policy,
+		class RNG = yamm_rand_rng>
+class yamm_engine {
+
+protected:
+
+	/** Memory map */
+	yamm_basic_extent_map<AddrT> map;
+
+	/** Random generator passed to the policy */
+	RNG rng;
+
+public:
+
+	typedef AddrT addr_t;
+	typedef Policy policy_t;
+
+	yamm_engine() {
+	}
+
+	/**
+	 * @param rng Random generator, copied
+	 */
+	yamm_engine(const RNG &rng) :
+			rng(rng) {
+	}
+
+	/**
+	 * Builds a memory that starts at 0
+	 *
+	 * @param size Size of the memory
+	 */
+	void build(AddrT size) {
+		map.build(0, size - 1);
+	}
+
+	/**
+	 * Builds a memory, build(0, ~(AddrT) 0) covers the whole AddrT range
+	 *
+	 * @param start_addr Start address of the memory
+	 * @param end_addr End address of the memory (inclusive)
+	 */
+	void build(AddrT start_addr, AddrT end_addr) {
+		map.build(start_addr, end_addr);
+	}
+
+	/**
+	 * Allocates a buffer according to Policy
+	 *
+	 * @param size Size of the buffer
+	 * @param alignment Start address alignment
+	 * @param granularity The size is rounded up to a multiple of it
+	 *
+	 * @return The buffer or YAMM_NO_EXTENT if there is no place for it
+	 */
+	uint_32_t allocate(AddrT size, AddrT alignment = 1, AddrT granularity = 1) {
+
+		if ((granularity > 1) && (size % granularity))
+			size += granularity - size % granularity;
+
+		return map.template allocate_with<Policy>(size, alignment, NULL, rng);
+	}
+
+	/**
+	 * Occupies [start_addr, start_addr + size - 1] if it's free
+	 *
+	 * @return The buffer or YAMM_NO_EXTENT if the range isn't free
+	 */
+	uint_32_t insert(AddrT start_addr, AddrT size) {
+		return map.insert(start_addr, size, NULL);
+	}
+
+	/**
+	 * Occupies the range of an access if it's free
+	 *
+	 * @return The buffer or YAMM_NO_EXTENT if the range isn't free
+	 */
+	uint_32_t insert_access(const yamm_basic_access<AddrT> &access) {
+		return map.insert(access.start_addr, access.size, NULL);
+	}
+
+	/**
+	 * Frees a buffer returned by allocate() or insert()
+	 *
+	 * @return 1 if successful
+	 */
+	bool deallocate(uint_32_t buffer) {
+		return map.deallocate(buffer);
+	}
+
+	/**
+	 * Frees the buffer that contains address
+	 *
+	 * @return 1 if successful
+	 */
+	bool deallocate_by_addr(AddrT address) {
+
+		uint_32_t buffer = map.find(address);
+
+		if ((buffer == YAMM_NO_EXTENT) || (map.get_is_free(buffer)))
+			return 0;
+
+		return map.deallocate(buffer);
+	}
+
+	/**
+	 * Returns the buffer that contains address or YAMM_NO_EXTENT if address is free
+	 */
+	uint_32_t find(AddrT address) {
+
+		uint_32_t buffer = map.find(address);
+
+		if ((buffer == YAMM_NO_EXTENT) || (map.get_is_free(buffer)))
+			return YAMM_NO_EXTENT;
+
+		return buffer;
+	}
+
+	AddrT get_start_addr(uint_32_t buffer) {
+		return map.get_start_addr(buffer);
+	}
+
+	AddrT get_end_addr(uint_32_t buffer) {
+		return map.get_end_addr(buffer);
+	}
+
+	AddrT get_size(uint_32_t buffer) {
+		return map.get_end_addr(buffer) - map.get_start_addr(buffer) + 1;
+	}
+
+	uint_32_t get_number_of_buffers() {
+		return map.get_number_of_extents();
+	}
+
+	AddrT get_free_bytes() {
+		return map.get_free_bytes();
+	}
+
+	/**
+	 * Returns the number of bytes used for the engine's metadata
+	 */
+	size_t get_memory_usage() {
+		return sizeof(*this) - sizeof(map) + map.get_memory_usage();
+	}
+
+	yamm_basic_extent_map<AddrT>& get_map() {
+		return map;
+	}
+
+	RNG& get_rng() {
+		return rng;
+	}
+
+};
+
+}
+#endif // __yamm_engine_h
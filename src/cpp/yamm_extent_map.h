@@ -0,0 +1,723 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_extent_map_h
+#define __yamm_extent_map_h
+
+#include <vector>
+#include <stddef.h>
+
+#include "yamm.h"
+#include "yamm_policies.h"
+
+namespace yamm_ns {
+
+/** Value of next_free for occupied extents */
+#define YAMM_EXTENT_USED 0xFFFFFFFEu
+
+/**
+ * Record that describes a free or occupied address range.
+ * Links are 32-bit indexes in the records vector so a record takes 24 bytes
+ * for 32-bit addresses, 32 bytes for 64-bit addresses and 48 bytes for 128-bit ones.
+ */
+template<class AddrT>
+class yamm_basic_extent {
+public:
+	/** Start address of the extent */
+	AddrT start_addr;
+	/** End address of the extent (inclusive) */
+	AddrT end_addr;
+	/** Next extent in memory (free or occupied) */
+	uint_32_t next;
+	/** Previous extent in memory (free or occupied) */
+	uint_32_t prev;
+	/** Next free extent, YAMM_EXTENT_USED for occupied extents */
+	uint_32_t next_free;
+	/** Previous free extent */
+	uint_32_t prev_free;
+};
+
+typedef yamm_basic_extent<uint_64_t> yamm_extent;
+typedef yamm_basic_extent<uint_32_t> yamm_extent_32;
+#ifdef __SIZEOF_INT128__
+typedef yamm_basic_extent<uint_128_t> yamm_extent_128;
+#endif
+
+/**
+ * Compact memory map: all the extents are kept in one vector of records
+ * and linked by indexes, so walking the map touches consecutive cache lines
+ * instead of heap nodes. An optional owner pointer can be kept for each occupied
+ * extent, in a separate vector (structure of arrays); the map never dereferences it.
+ *
+ * The allocation policies are in yamm_policies.h. allocate_with() takes the policy as a
+ * template argument so the search and placement are inlined, allocate() picks one
+ * of the YAMM allocation modes at runtime (YAMM_RANDOM_FIT ... YAMM_UNIFORM_FIT and
+ * YAMM_RANDOM_ADDR_FIT; the stateful YAMM_BUDDY_FIT, YAMM_TLSF_FIT and YAMM_NEXT_FIT
+ * are rejected).
+ *
+ * The map is the storage of yamm_engine, the yamm class doesn't use it: yamm hands
+ * out yamm_buffer* handles that stay valid while other buffers come and go, nest
+ * (recursion) and carry contents, observers and slabs, while extents are 32-bit
+ * indexes that get recycled. There is no recursion inside an extent map.
+ */
+template<class AddrT>
+class yamm_basic_extent_map {
+
+public:
+
+	/** Address type, used by the policies */
+	typedef AddrT addr_t;
+	/** Record type */
+	typedef yamm_basic_extent<AddrT> extent_t;
+
+protected:
+
+	/** All the records, free and occupied */
+	std::vector<extent_t> extents;
+	/** Handle of each occupied extent, NULL for free ones. Only grown once a handle
+	 * is set so maps used without handles (e.g. by yamm_engine) don't pay for it */
+	std::vector<yamm_buffer*> owners;
+
+	/** First extent in memory */
+	uint_32_t first;
+	/** First free extent in memory */
+	uint_32_t first_free;
+	/** Head of the list of unused records, chained by next */
+	uint_32_t recycled;
+
+	/** Number of occupied extents */
+	uint_32_t number_of_extents;
+	/** Number of free extents */
+	uint_32_t number_of_free_extents;
+	/** Total size of the free extents */
+	AddrT free_bytes;
+
+	/** Start address of the memory */
+	AddrT start_addr;
+	/** End address of the memory */
+	AddrT end_addr;
+
+	/** Generator used by allocate() */
+	yamm_rand_rng rng;
+
+	/**
+	 * Returns an unused record, reusing the ones freed by merges
+	 */
+	uint_32_t new_extent(AddrT start_addr, AddrT end_addr);
+
+	/**
+	 * Puts a record in the list of unused records
+	 */
+	void delete_extent(uint_32_t extent);
+
+	/**
+	 * Links extent in memory right after prev (or as first if prev is YAMM_NO_EXTENT)
+	 */
+	void link_after(uint_32_t prev, uint_32_t extent);
+
+	/**
+	 * Removes extent from the memory list
+	 */
+	void unlink(uint_32_t extent);
+
+	/**
+	 * Links a free extent in the free list right after prev_free (or as first_free)
+	 */
+	void link_free_after(uint_32_t prev_free, uint_32_t extent);
+
+	/**
+	 * Removes extent from the free list and marks it as occupied
+	 */
+	void unlink_free(uint_32_t extent);
+
+	/**
+	 * Sets the handle of an extent
+	 */
+	void set_owner(uint_32_t extent, yamm_buffer* owner) {
+		if (extent >= owners.size()) {
+			if (owner == NULL)
+				return;
+			owners.resize(extents.size(), NULL);
+		}
+		owners[extent] = owner;
+	}
+
+	/**
+	 * Splits the free extent so [start_addr, start_addr + size - 1] becomes occupied
+	 *
+	 * @return The occupied extent
+	 */
+	uint_32_t add(uint_32_t free_extent, AddrT start_addr, AddrT size);
+
+public:
+
+	/**
+	 * Creates an empty map, build() has to be called before using it
+	 */
+	yamm_basic_extent_map();
+
+	/**
+	 * Builds the memory, everything is free
+	 *
+	 * @param start_addr Start address of the memory
+	 * @param end_addr End address of the memory (inclusive)
+	 */
+	void build(AddrT start_addr, AddrT end_addr);
+
+	/**
+	 * Allocates size bytes according to Policy, without any runtime dispatch
+	 *
+	 * @param size Size of the new extent, already rounded to the granularity
+	 * @param alignment Start address alignment
+	 * @param owner Handle kept for the extent, can be NULL
+	 * @param rng Random generator used by the policy
+	 *
+	 * @return The occupied extent or YAMM_NO_EXTENT if there is no place for it
+	 */
+	template<class Policy, class RNG>
+	uint_32_t allocate_with(AddrT size, AddrT alignment, yamm_buffer* owner,
+			RNG &rng) {
+
+		if (first == YAMM_NO_EXTENT) {
+			fprintf(stderr,
+					"[YAMM_ERR] Memory wasn't built!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+
+		if ((size == 0) || (alignment == 0))
+			return YAMM_NO_EXTENT;
+
+		uint_32_t free_extent = Policy::find(*this, size, alignment, rng);
+
+		if (free_extent == YAMM_NO_EXTENT)
+			return YAMM_NO_EXTENT;
+
+		uint_32_t extent = add(free_extent,
+				Policy::place(*this, free_extent, size, alignment, rng), size);
+		set_owner(extent, owner);
+		return extent;
+	}
+
+	/**
+	 * Allocates size bytes according to allocation_mode
+	 *
+	 * @param size Size of the new extent, already rounded to the granularity
+	 * @param alignment Start address alignment
+	 * @param allocation_mode One of the YAMM allocation modes, except YAMM_BUDDY_FIT,
+	 * YAMM_TLSF_FIT and YAMM_NEXT_FIT which have no policy
+	 * @param owner Handle kept for the extent, can be NULL
+	 *
+	 * @return The occupied extent or YAMM_NO_EXTENT if there is no place for it
+	 */
+	uint_32_t allocate(AddrT size, AddrT alignment, int allocation_mode,
+			yamm_buffer* owner) {
+
+		switch (allocation_mode) {
+		case YAMM_RANDOM_FIT:
+			return allocate_with<yamm_random_fit_policy>(size, alignment, owner, rng);
+		case YAMM_FIRST_FIT_RND:
+			return allocate_with<yamm_first_fit_rnd_policy>(size, alignment, owner, rng);
+		case YAMM_BEST_FIT_RND:
+			return allocate_with<yamm_best_fit_rnd_policy>(size, alignment, owner, rng);
+		case YAMM_FIRST_FIT:
+			return allocate_with<yamm_first_fit_policy>(size, alignment, owner, rng);
+		case YAMM_BEST_FIT:
+			return allocate_with<yamm_best_fit_policy>(size, alignment, owner, rng);
+		case YAMM_UNIFORM_FIT:
+			return allocate_with<yamm_uniform_fit_policy>(size, alignment, owner, rng);
+		case YAMM_RANDOM_ADDR_FIT:
+			return allocate_with<yamm_random_addr_fit_policy>(size, alignment, owner, rng);
+		case YAMM_BUDDY_FIT ... YAMM_NEXT_FIT:
+			fprintf(stderr,
+					"[YAMM_WRN] Allocation mode %d isn't supported by the extent map!\n\t in %s at line %d\n",
+					allocation_mode, __FILE__, __LINE__);
+			return YAMM_NO_EXTENT;
+		default:
+			return YAMM_NO_EXTENT;
+		}
+	}
+
+	/**
+	 * Occupies the range starting at start_addr if it's free
+	 *
+	 * @return The occupied extent or YAMM_NO_EXTENT if the range isn't free
+	 */
+	uint_32_t insert(AddrT start_addr, AddrT size, yamm_buffer* owner);
+
+	/**
+	 * Frees an occupied extent and merges it with the neighboring free extents
+	 *
+	 * @return 1 if successful
+	 */
+	bool deallocate(uint_32_t extent);
+
+	/**
+	 * Returns the extent (free or occupied) containing address or YAMM_NO_EXTENT
+	 */
+	uint_32_t find(AddrT address);
+
+	/**
+	 * Computes the first aligned address where size bytes fit in a free extent
+	 *
+	 * @return 1 if size fits in the extent
+	 */
+	bool fits(uint_32_t extent, AddrT size, AddrT alignment,
+			AddrT &aligned_addr);
+
+	uint_32_t get_first() {
+		return first;
+	}
+
+	uint_32_t get_first_free() {
+		return first_free;
+	}
+
+	uint_32_t get_next(uint_32_t extent) {
+		return extents[extent].next;
+	}
+
+	uint_32_t get_next_free(uint_32_t extent) {
+		return extents[extent].next_free;
+	}
+
+	uint_32_t get_prev_free(uint_32_t extent) {
+		return extents[extent].prev_free;
+	}
+
+	AddrT get_start_addr(uint_32_t extent) {
+		return extents[extent].start_addr;
+	}
+
+	AddrT get_end_addr(uint_32_t extent) {
+		return extents[extent].end_addr;
+	}
+
+	bool get_is_free(uint_32_t extent) {
+		return extents[extent].next_free != YAMM_EXTENT_USED;
+	}
+
+	yamm_buffer* get_owner(uint_32_t extent) {
+		return (extent < owners.size()) ? owners[extent] : NULL;
+	}
+
+	uint_32_t get_number_of_extents() {
+		return number_of_extents;
+	}
+
+	uint_32_t get_number_of_free_extents() {
+		return number_of_free_extents;
+	}
+
+	/**
+	 * Returns the total size of the free extents. It wraps to 0 for a free map that
+	 * spans the whole AddrT range, use a wider AddrT if that matters.
+	 */
+	AddrT get_free_bytes() {
+		return free_bytes;
+	}
+
+	/**
+	 * Returns the number of bytes used for the map's metadata
+	 */
+	size_t get_memory_usage() {
+		return sizeof(*this) + extents.capacity() * sizeof(extent_t)
+				+ owners.capacity() * sizeof(yamm_buffer*);
+	}
+
+	/**
+	 * Checks the links, continuity and counters of the map
+	 *
+	 * @return 1 if the map is consistent
+	 */
+	bool check_consistency();
+
+};
+
+typedef yamm_basic_extent_map<uint_64_t> yamm_extent_map;
+typedef yamm_basic_extent_map<uint_32_t> yamm_extent_map_32;
+#ifdef __SIZEOF_INT128__
+typedef yamm_basic_extent_map<uint_128_t> yamm_extent_map_128;
+#endif
+
+template<class AddrT>
+yamm_basic_extent_map<AddrT>::yamm_basic_extent_map() {
+
+	first = YAMM_NO_EXTENT;
+	first_free = YAMM_NO_EXTENT;
+	recycled = YAMM_NO_EXTENT;
+
+	number_of_extents = 0;
+	number_of_free_extents = 0;
+	free_bytes = 0;
+
+	start_addr = 0;
+	end_addr = 0;
+}
+
+template<class AddrT>
+void yamm_basic_extent_map<AddrT>::build(AddrT start_addr, AddrT end_addr) {
+
+	if (first != YAMM_NO_EXTENT) {
+		fprintf(stderr,
+				"[YAMM_WRN] Memory is already built!\n\t in %s at line %d\n",
+				__FILE__, __LINE__);
+		return;
+	}
+
+	this->start_addr = start_addr;
+	this->end_addr = end_addr;
+
+	first = new_extent(start_addr, end_addr);
+	extents[first].next_free = YAMM_NO_EXTENT;
+	first_free = first;
+
+	number_of_free_extents = 1;
+	free_bytes = end_addr - start_addr + 1;
+}
+
+template<class AddrT>
+uint_32_t yamm_basic_extent_map<AddrT>::new_extent(AddrT start_addr,
+		AddrT end_addr) {
+
+	uint_32_t extent;
+
+	if (recycled != YAMM_NO_EXTENT) {
+		extent = recycled;
+		recycled = extents[recycled].next;
+	} else {
+		if (extents.size() >= YAMM_EXTENT_USED) {
+			fprintf(stderr,
+					"[YAMM_ERR] Too many extents in the map!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+			exit(YAMM_EXIT_CODE);
+		}
+		extent = extents.size();
+		extents.push_back(extent_t());
+	}
+
+	extent_t &e = extents[extent];
+	e.start_addr = start_addr;
+	e.end_addr = end_addr;
+	e.next = YAMM_NO_EXTENT;
+	e.prev = YAMM_NO_EXTENT;
+	e.next_free = YAMM_EXTENT_USED;
+	e.prev_free = YAMM_NO_EXTENT;
+	set_owner(extent, NULL);
+
+	return extent;
+}
+
+template<class AddrT>
+void yamm_basic_extent_map<AddrT>::delete_extent(uint_32_t extent) {
+	set_owner(extent, NULL);
+	extents[extent].next_free = YAMM_EXTENT_USED;
+	// Marks the record as unused
+	extents[extent].prev = YAMM_EXTENT_USED;
+	extents[extent].next = recycled;
+	recycled = extent;
+}
+
+template<class AddrT>
+void yamm_basic_extent_map<AddrT>::link_after(uint_32_t prev, uint_32_t extent) {
+
+	uint_32_t next = (prev == YAMM_NO_EXTENT) ? first : extents[prev].next;
+
+	extents[extent].prev = prev;
+	extents[extent].next = next;
+
+	if (prev == YAMM_NO_EXTENT)
+		first = extent;
+	else
+		extents[prev].next = extent;
+
+	if (next != YAMM_NO_EXTENT)
+		extents[next].prev = extent;
+}
+
+template<class AddrT>
+void yamm_basic_extent_map<AddrT>::unlink(uint_32_t extent) {
+
+	uint_32_t prev = extents[extent].prev;
+	uint_32_t next = extents[extent].next;
+
+	if (prev == YAMM_NO_EXTENT)
+		first = next;
+	else
+		extents[prev].next = next;
+
+	if (next != YAMM_NO_EXTENT)
+		extents[next].prev = prev;
+}
+
+template<class AddrT>
+void yamm_basic_extent_map<AddrT>::link_free_after(uint_32_t prev_free, uint_32_t extent) {
+
+	uint_32_t next_free =
+			(prev_free == YAMM_NO_EXTENT) ?
+					first_free : extents[prev_free].next_free;
+
+	extents[extent].prev_free = prev_free;
+	extents[extent].next_free = next_free;
+
+	if (prev_free == YAMM_NO_EXTENT)
+		first_free = extent;
+	else
+		extents[prev_free].next_free = extent;
+
+	if (next_free != YAMM_NO_EXTENT)
+		extents[next_free].prev_free = extent;
+}
+
+template<class AddrT>
+void yamm_basic_extent_map<AddrT>::unlink_free(uint_32_t extent) {
+
+	uint_32_t prev_free = extents[extent].prev_free;
+	uint_32_t next_free = extents[extent].next_free;
+
+	if (prev_free == YAMM_NO_EXTENT)
+		first_free = next_free;
+	else
+		extents[prev_free].next_free = next_free;
+
+	if (next_free != YAMM_NO_EXTENT)
+		extents[next_free].prev_free = prev_free;
+
+	extents[extent].next_free = YAMM_EXTENT_USED;
+	extents[extent].prev_free = YAMM_NO_EXTENT;
+}
+
+template<class AddrT>
+bool yamm_basic_extent_map<AddrT>::fits(uint_32_t extent, AddrT size,
+		AddrT alignment, AddrT &aligned_addr) {
+
+	const extent_t &e = extents[extent];
+
+	AddrT displacement = (alignment - e.start_addr % alignment)
+			% alignment;
+
+	// The displacement alone doesn't fit
+	if (displacement > e.end_addr - e.start_addr)
+		return 0;
+
+	aligned_addr = e.start_addr + displacement;
+
+	// Compare sizes minus one so a free extent that spans the whole address space doesn't overflow
+	return (size - 1) <= (e.end_addr - aligned_addr);
+}
+
+template<class AddrT>
+uint_32_t yamm_basic_extent_map<AddrT>::add(uint_32_t free_extent, AddrT start_addr,
+		AddrT size) {
+
+	extent_t &f = extents[free_extent];
+	AddrT new_end_addr = start_addr + (size - 1);
+	uint_32_t extent;
+
+	if ((start_addr == f.start_addr) && (new_end_addr == f.end_addr)) {
+		// [ new ] : the free extent becomes occupied
+		unlink_free(free_extent);
+		number_of_free_extents--;
+		extent = free_extent;
+	} else if (start_addr == f.start_addr) {
+		// [ new | free ]
+		extent = new_extent(start_addr, new_end_addr);
+		extents[free_extent].start_addr = new_end_addr + 1;
+		link_after(extents[free_extent].prev, extent);
+	} else if (new_end_addr == f.end_addr) {
+		// [ free | new ]
+		extent = new_extent(start_addr, new_end_addr);
+		extents[free_extent].end_addr = start_addr - 1;
+		link_after(free_extent, extent);
+	} else {
+		// [ free | new | free ]
+		AddrT old_end_addr = f.end_addr;
+		extent = new_extent(start_addr, new_end_addr);
+		uint_32_t right = new_extent(new_end_addr + 1, old_end_addr);
+		extents[free_extent].end_addr = start_addr - 1;
+		link_after(free_extent, extent);
+		link_after(extent, right);
+		link_free_after(free_extent, right);
+		number_of_free_extents++;
+	}
+
+	number_of_extents++;
+	free_bytes -= size;
+	return extent;
+}
+
+template<class AddrT>
+uint_32_t yamm_basic_extent_map<AddrT>::insert(AddrT start_addr, AddrT size,
+		yamm_buffer* owner) {
+
+	if ((size == 0) || (start_addr < this->start_addr)
+			|| (start_addr > this->end_addr))
+		return YAMM_NO_EXTENT;
+
+	// Only free extents can hold it so the free list is enough
+	uint_32_t extent = first_free;
+	while ((extent != YAMM_NO_EXTENT) && (extents[extent].end_addr < start_addr))
+		extent = extents[extent].next_free;
+
+	if ((extent == YAMM_NO_EXTENT) || (extents[extent].start_addr > start_addr)
+			|| ((size - 1) > (extents[extent].end_addr - start_addr)))
+		return YAMM_NO_EXTENT;
+
+	uint_32_t new_extent = add(extent, start_addr, size);
+	set_owner(new_extent, owner);
+	return new_extent;
+}
+
+template<class AddrT>
+bool yamm_basic_extent_map<AddrT>::deallocate(uint_32_t extent) {
+
+	if ((extent >= extents.size()) || (get_is_free(extent))
+			|| (extents[extent].prev == YAMM_EXTENT_USED))
+		return 0;
+
+	uint_32_t prev = extents[extent].prev;
+	uint_32_t next = extents[extent].next;
+	bool prev_free = (prev != YAMM_NO_EXTENT) && get_is_free(prev);
+	bool next_free = (next != YAMM_NO_EXTENT) && get_is_free(next);
+
+	free_bytes += extents[extent].end_addr - extents[extent].start_addr + 1;
+	number_of_extents--;
+
+	if (prev_free) {
+		// The previous free extent grows over the freed one, and over the next one if it's free
+		extents[prev].end_addr = extents[extent].end_addr;
+		unlink(extent);
+		delete_extent(extent);
+
+		if (next_free) {
+			extents[prev].end_addr = extents[next].end_addr;
+			unlink_free(next);
+			unlink(next);
+			delete_extent(next);
+			number_of_free_extents--;
+		}
+		return 1;
+	}
+
+	if (next_free) {
+		// The next free extent grows over the freed one
+		extents[next].start_addr = extents[extent].start_addr;
+		unlink(extent);
+		delete_extent(extent);
+		return 1;
+	}
+
+	// No free neighbor: find the closest free extent on either side to link in the free list
+	uint_32_t left = prev;
+	uint_32_t right = next;
+	uint_32_t prev_free_extent = YAMM_NO_EXTENT;
+
+	while ((left != YAMM_NO_EXTENT) || (right != YAMM_NO_EXTENT)) {
+		if (left != YAMM_NO_EXTENT) {
+			if (get_is_free(left)) {
+				prev_free_extent = left;
+				break;
+			}
+			left = extents[left].prev;
+		}
+		if (right != YAMM_NO_EXTENT) {
+			if (get_is_free(right)) {
+				prev_free_extent = extents[right].prev_free;
+				break;
+			}
+			right = extents[right].next;
+		}
+	}
+
+	set_owner(extent, NULL);
+	link_free_after(prev_free_extent, extent);
+	number_of_free_extents++;
+	return 1;
+}
+
+template<class AddrT>
+uint_32_t yamm_basic_extent_map<AddrT>::find(AddrT address) {
+
+	if ((first == YAMM_NO_EXTENT) || (address < start_addr)
+			|| (address > end_addr))
+		return YAMM_NO_EXTENT;
+
+	uint_32_t extent = first;
+	while (extents[extent].end_addr < address)
+		extent = extents[extent].next;
+
+	return extent;
+}
+
+template<class AddrT>
+bool yamm_basic_extent_map<AddrT>::check_consistency() {
+
+	uint_32_t extent = first;
+	uint_32_t prev = YAMM_NO_EXTENT;
+	uint_32_t prev_free = YAMM_NO_EXTENT;
+	uint_32_t used = 0;
+	uint_32_t free = 0;
+	AddrT free_size = 0;
+
+	if ((extent == YAMM_NO_EXTENT) || (extents[extent].start_addr != start_addr))
+		return 0;
+
+	while (extent != YAMM_NO_EXTENT) {
+
+		const extent_t &e = extents[extent];
+
+		if ((e.prev != prev) || (e.end_addr < e.start_addr))
+			return 0;
+
+		if ((prev != YAMM_NO_EXTENT)
+				&& (extents[prev].end_addr + 1 != e.start_addr))
+			return 0;
+
+		if (get_is_free(extent)) {
+			// Merged and linked in address order
+			if ((prev != YAMM_NO_EXTENT) && (get_is_free(prev)))
+				return 0;
+			if (e.prev_free != prev_free)
+				return 0;
+			if ((prev_free == YAMM_NO_EXTENT) ?
+					(first_free != extent) :
+					(extents[prev_free].next_free != extent))
+				return 0;
+			prev_free = extent;
+			free++;
+			free_size += e.end_addr - e.start_addr + 1;
+		} else
+			used++;
+
+		prev = extent;
+		extent = e.next;
+	}
+
+	if (extents[prev].end_addr != end_addr)
+		return 0;
+
+	if ((prev_free == YAMM_NO_EXTENT) ?
+			(first_free != YAMM_NO_EXTENT) :
+			(extents[prev_free].next_free != YAMM_NO_EXTENT))
+		return 0;
+
+	return (used == number_of_extents) && (free == number_of_free_extents)
+			&& (free_size == free_bytes);
+}
+
+}
+#endif // __yamm_extent_map_h
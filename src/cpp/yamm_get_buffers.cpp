@@ -19,6 +19,7 @@
 #define __yamm_get_buffers
 
 #include "yamm.h"
+#include <algorithm>
 
 using namespace yamm_ns;
 
@@ -34,9 +35,16 @@ yamm_buffer* yamm_buffer::get_buffer(uint_64_t start) {
 		exit(YAMM_EXIT_CODE);
 	}
 
+	// The slot is found directly, NULL if it's free
+	if (is_slab())
+		return internal_get_buffer(start);
+
+	YAMM_COUNT(buffer_lookups);
+
 	// Traverse the memory until the buffer containing that address is found
 	while ((temp->next) && (temp->end_addr < start)) {
 		temp = temp->next;
+		YAMM_COUNT(buffer_lookup_steps);
 	}
 
 	if (start >= temp->start_addr)
@@ -64,9 +72,19 @@ yamm_buffer* yamm_buffer::internal_get_buffer(uint_64_t start) {
 		exit(YAMM_EXIT_CODE);
 	}
 
+	YAMM_COUNT(buffer_lookups);
+
+	// Free slots have no buffer
+	if (is_slab()) {
+		uint_64_t slot = (start - this->start_addr) / container_state->slab_slot_size;
+		return (slot < container_state->slab_number_of_slots) ?
+				container_state->slab_slots[slot] : NULL;
+	}
+
 	// Traverse the memory until the buffer containing that address is found
 	while ((temp->next) && (temp->end_addr < start)) {
 		temp = temp->next;
+		YAMM_COUNT(buffer_lookup_steps);
 	}
 
 	if (start >= temp->start_addr)
@@ -92,6 +110,30 @@ std::vector<yamm_buffer> yamm_buffer::get_buffers_in_range(uint_64_t start_addr,
 		return queue;
 	}
 
+	// Go through the occupied slots from the one that contains start_addr, a bitmap word at a time
+	if (is_slab()) {
+		uint_64_t slot = (start_addr - this->start_addr) / container_state->slab_slot_size;
+
+		while (slot < container_state->slab_number_of_slots) {
+
+			uint_64_t occupied = container_state->slab_bitmap[slot >> 6] >> (slot & 63);
+			if (!occupied) {
+				slot = (slot | 63) + 1;
+				continue;
+			}
+
+			slot += __builtin_ctzll(occupied);
+			if ((slot >= container_state->slab_number_of_slots)
+					|| (container_state->slab_slots[slot]->end_addr > end_addr))
+				break;
+
+			queue.push_back(container_state->slab_slots[slot]);
+			slot++;
+		}
+
+		return queue;
+	}
+
 	// Traverse the memory
 	while ((temp) &&(temp->end_addr <= end_addr)) {
 		if (temp->is_free == 0) {
@@ -103,6 +145,85 @@ std::vector<yamm_buffer> yamm_buffer::get_buffers_in_range(uint_64_t start_addr,
 	return queue;
 }
 
+std::vector<yamm_access> yamm_buffer::get_free_ranges(uint_64_t start_addr,
+		uint_64_t end_addr, uint_64_t size, uint_64_t alignment) {
+
+	std::vector<yamm_access> ranges;
+
+	if ((end_addr < start_addr) || (alignment == 0)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Invalid parameters: %llu %llu !\n\t in %s at line %d\n",
+					start_addr, end_addr, __FILE__, __LINE__);
+		return ranges;
+	}
+
+	if ((start_addr > this->end_addr) || (end_addr < this->start_addr))
+		return ranges;
+
+	start_addr = std::max(start_addr, this->start_addr);
+	end_addr = std::min(end_addr, this->end_addr);
+
+	// Each free slot is a free buffer
+	if (is_slab()) {
+		uint_64_t slot = (start_addr - this->start_addr) / container_state->slab_slot_size;
+		uint_64_t last_slot = std::min(container_state->slab_number_of_slots,
+				(end_addr - this->start_addr) / container_state->slab_slot_size + 1);
+
+		while (slot < last_slot) {
+
+			slot = find_slot(slot, last_slot - 1, 1);
+			if (slot == YAMM_NO_SLOT)
+				break;
+
+			uint_64_t slot_addr = this->start_addr + slot * container_state->slab_slot_size;
+			add_free_range(ranges, std::max(slot_addr, start_addr),
+					std::min(slot_addr + container_state->slab_slot_size - 1,
+							end_addr), size, alignment);
+			slot++;
+		}
+
+		return ranges;
+	}
+
+	// Nothing was allocated inside yet, the whole buffer is free
+	if (!first) {
+		add_free_range(ranges, start_addr, end_addr, size, alignment);
+		return ranges;
+	}
+
+	// The free buffer that contains start_addr or the first one after it
+	std::map<uint_64_t, yamm_buffer*>::iterator it =
+			container_state->free_by_addr.upper_bound(start_addr);
+	if (it != container_state->free_by_addr.begin()) {
+		--it;
+		if (it->second->end_addr < start_addr)
+			++it;
+	}
+
+	for (; (it != container_state->free_by_addr.end()) && (it->first <= end_addr); ++it)
+		add_free_range(ranges, std::max(it->first, start_addr),
+				std::min(it->second->end_addr, end_addr), size, alignment);
+
+	return ranges;
+}
+
+void yamm_buffer::add_free_range(std::vector<yamm_access> &ranges,
+		uint_64_t start_addr, uint_64_t end_addr, uint_64_t size,
+		uint_64_t alignment) {
+
+	// A buffer of size bytes aligned to alignment must fit in the range
+	if (size) {
+		uint_64_t first_addr = start_addr
+				+ (alignment - start_addr % alignment) % alignment;
+		if ((first_addr < start_addr) || (first_addr > end_addr)
+				|| (end_addr - first_addr < size - 1))
+			return;
+	}
+
+	ranges.push_back(yamm_access(start_addr, end_addr - start_addr + 1));
+}
+
 std::vector<yamm_buffer> yamm_buffer::get_buffers_by_access(
 		yamm_access* access) {
 
@@ -126,6 +247,12 @@ std::vector<yamm_buffer> yamm_buffer::get_buffers_by_name(
 		return result;
 	}
 
+	for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots; ++slot)
+		if ((container_state->slab_slots[slot])
+				&& (container_state->slab_slots[slot]->get_name().compare(
+						name_to_search) == 0))
+			result.push_back(container_state->slab_slots[slot]);
+
 	yamm_buffer* iterator = this->first;
 
 	while (iterator) {
@@ -19,11 +19,11 @@
 #define __yamm_insert
 
 #include "yamm.h"
+#include <algorithm>
 
 using namespace yamm_ns;
 
-bool yamm_buffer::insert(yamm_buffer* n) {
-	yamm_buffer* temp;
+bool yamm_buffer::check_inserted_buffer(yamm_buffer* n) {
 
 	// Check given buffer
 	if (!n) {
@@ -42,16 +42,6 @@ bool yamm_buffer::insert(yamm_buffer* n) {
 		return 0;
 	}
 
-	// If there is no handle to the first buffer then the memory map is not initialized
-	if (!first) {
-		first_free = new yamm_buffer; // Initialize it with a new free buffer of the same size as the memory map
-		first_free->start_addr = start_addr;
-		first_free->size = size;
-		first_free->end_addr = first_free->start_addr + first_free->size - 1;
-		first_free->is_free = 1;
-		first = first_free;
-	}
-
 	if (n->start_addr_alignment == 0) {
 		fprintf(stderr,
 				"[YAMM_ERR] Alignment can't be 0!\n\t in %s at line %d\n",
@@ -78,8 +68,6 @@ bool yamm_buffer::insert(yamm_buffer* n) {
 					__FILE__, __LINE__);
 	}
 
-	// Get the buffer the contains the address of n
-	temp = internal_get_buffer(n->start_addr);
 	// Calculate buffer end address
 	n->end_addr = n->start_addr + n->size - 1;
 	if (n->end_addr < n->start_addr) {
@@ -89,6 +77,12 @@ bool yamm_buffer::insert(yamm_buffer* n) {
 					__FILE__, __LINE__);
 		return 0;
 	}
+
+	return 1;
+}
+
+bool yamm_buffer::insert_in_free_buffer(yamm_buffer* n, yamm_buffer* temp) {
+
 	if (!temp) {
 		if (!disable_warnings)
 			fprintf(stderr,
@@ -122,8 +116,78 @@ bool yamm_buffer::insert(yamm_buffer* n) {
 	}
 
 	add(n, temp);
+	n->is_inserted = 1;
+
+	notify(YAMM_EVENT_INSERT, n, YAMM_NO_MODE, 0, 0);
 	return 1;
+}
+
+bool yamm_buffer::insert(yamm_buffer* n) {
+
+	if (!check_inserted_buffer(n))
+		return 0;
+
+	// A slab only accepts buffers that match a slot
+	if (is_slab())
+		return insert_slot(n);
+
+	// If there is no handle to the first buffer then the memory map is not initialized
+	init_free_buffer();
+
+	// Get the buffer the contains the address of n
+	return insert_in_free_buffer(n, internal_get_buffer(n->start_addr));
+
+}
 
+std::vector<bool> yamm_buffer::insert_batch(
+		std::vector<yamm_buffer*> &buffers) {
+
+	std::vector<bool> inserted(buffers.size(), 0);
+
+	// (start address, position) of the valid buffers, sorted by start address
+	std::vector<std::pair<uint_64_t, uint_64_t> > order;
+	order.reserve(buffers.size());
+
+	for (uint_64_t i = 0; i < buffers.size(); ++i)
+		if (check_inserted_buffer(buffers[i]))
+			order.push_back(std::make_pair(buffers[i]->start_addr, i));
+
+	std::sort(order.begin(), order.end());
+
+	if (is_slab()) {
+		for (uint_64_t i = 0; i < order.size(); ++i)
+			inserted[order[i].second] = insert_slot(buffers[order[i].second]);
+		return inserted;
+	}
+
+	init_free_buffer();
+
+	// One pass over the memory map: the search for each buffer starts where the
+	// previous one ended, every buffer inserted is linked at that point
+	yamm_buffer* temp = first;
+
+	for (uint_64_t i = 0; i < order.size(); ++i) {
+
+		yamm_buffer* n = buffers[order[i].second];
+
+		if ((n->start_addr < start_addr) || (n->start_addr > end_addr)) {
+			if (!disable_warnings)
+				fprintf(stderr,
+						"[YAMM_WRN]  The starting address of the buffer is not in memory!\n\t in %s at line %d\n",
+						__FILE__, __LINE__);
+			continue;
+		}
+
+		while ((temp->next) && (temp->end_addr < n->start_addr))
+			temp = temp->next;
+
+		if (insert_in_free_buffer(n, temp)) {
+			inserted[order[i].second] = 1;
+			temp = n;
+		}
+	}
+
+	return inserted;
 }
 
 bool yamm::allocate_static(yamm_buffer* n) {
@@ -163,4 +227,27 @@ yamm_buffer* yamm_buffer::insert_access(yamm_access* access) {
 
 }
 
+std::vector<yamm_buffer*> yamm_buffer::insert_accesses(
+		std::vector<yamm_access> &accesses) {
+
+	std::vector<yamm_buffer*> buffers(accesses.size());
+
+	for (uint_64_t i = 0; i < accesses.size(); ++i) {
+		buffers[i] = new yamm_buffer;
+		buffers[i]->start_addr = accesses[i].start_addr;
+		buffers[i]->end_addr = accesses[i].end_addr;
+		buffers[i]->size = accesses[i].size;
+	}
+
+	std::vector<bool> inserted = insert_batch(buffers);
+
+	for (uint_64_t i = 0; i < buffers.size(); ++i)
+		if (!inserted[i]) {
+			delete buffers[i];
+			buffers[i] = NULL;
+		}
+
+	return buffers;
+}
+
 #endif // __yamm_insert
@@ -0,0 +1,58 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_observer
+#define __yamm_observer
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+uint yamm_buffer::number_of_observers = 0;
+
+void yamm_buffer::set_observer(yamm_observer* new_observer) {
+
+	if ((!container_state) && (!new_observer))
+		return;
+
+	yamm_container_state* state = get_container_state();
+
+	if ((!state->observer) && (new_observer))
+		number_of_observers++;
+	else if ((state->observer) && (!new_observer))
+		number_of_observers--;
+
+	state->observer = new_observer;
+}
+
+void yamm_buffer::notify_observers(int kind, yamm_buffer* buffer,
+		int allocation_mode, uint_64_t old_start_addr, uint_64_t old_end_addr) {
+
+	unsigned int level = 0;
+	for (yamm_buffer* temp = parent; temp; temp = temp->parent)
+		level++;
+
+	yamm_event event(kind, level, this, buffer, allocation_mode,
+			buffer ? buffer->start_addr : start_addr,
+			buffer ? buffer->end_addr : end_addr, old_start_addr, old_end_addr);
+
+	for (yamm_buffer* temp = this; temp; temp = temp->parent)
+		if ((temp->container_state) && (temp->container_state->observer))
+			temp->container_state->observer->notify(event);
+}
+
+#endif // __yamm_observer
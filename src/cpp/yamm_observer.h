@@ -0,0 +1,107 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_observer_h
+#define __yamm_observer_h
+
+namespace yamm_ns {
+
+#ifndef uint_64_t
+typedef unsigned long long int uint_64_t;
+#endif
+
+class yamm_buffer;
+
+/** Buffer was allocated by allocate() or allocate_in_range() */
+#define YAMM_EVENT_ALLOCATE 0
+/** Buffer was inserted by insert() or insert_batch() */
+#define YAMM_EVENT_INSERT 1
+/** Buffer is deallocated, it's deleted after the event */
+#define YAMM_EVENT_DEALLOCATE 2
+/** Buffer was resized by resize(), it can be at another address */
+#define YAMM_EVENT_RESIZE 3
+/** Buffer was moved by compact() */
+#define YAMM_EVENT_MOVE 4
+/** Memory map is soft reset, a deallocation event follows for each buffer freed */
+#define YAMM_EVENT_SOFT_RESET 5
+/** Memory map is hard reset, a deallocation event follows for each buffer freed */
+#define YAMM_EVENT_HARD_RESET 6
+
+/** Allocation mode of the events that don't search for a place */
+#define YAMM_NO_MODE -1
+
+/**
+ * Class that describes a change of a memory map
+ */
+class yamm_event {
+public:
+
+	/** Kind of change, one of YAMM_EVENT_* */
+	int kind;
+	/** Recursion level of the memory map, 0 is the top level memory */
+	unsigned int level;
+	/** Buffer that contains the memory map */
+	yamm_buffer* container;
+	/** Buffer that changed, NULL for a reset */
+	yamm_buffer* buffer;
+	/** Allocation mode used to place the buffer, or YAMM_NO_MODE */
+	int allocation_mode;
+	/** Start address of the buffer, or of the container for a reset */
+	uint_64_t start_addr;
+	/** End address of the buffer, or of the container for a reset */
+	uint_64_t end_addr;
+	/** Start address before a deallocation, resize or move, 0 otherwise */
+	uint_64_t old_start_addr;
+	/** End address before a deallocation, resize or move, 0 otherwise */
+	uint_64_t old_end_addr;
+
+	yamm_event(int kind, unsigned int level, yamm_buffer* container,
+			yamm_buffer* buffer, int allocation_mode, uint_64_t start_addr,
+			uint_64_t end_addr, uint_64_t old_start_addr,
+			uint_64_t old_end_addr) {
+		this->kind = kind;
+		this->level = level;
+		this->container = container;
+		this->buffer = buffer;
+		this->allocation_mode = allocation_mode;
+		this->start_addr = start_addr;
+		this->end_addr = end_addr;
+		this->old_start_addr = old_start_addr;
+		this->old_end_addr = old_end_addr;
+	}
+
+};
+
+/**
+ * Receives the changes of a memory map and of all the memory maps nested in it,
+ * attached with yamm_buffer::set_observer()
+ */
+class yamm_observer {
+public:
+
+	/**
+	 * Called after each change, before the buffer is deleted for a deallocation.
+	 * The memory maps shouldn't be changed from here.
+	 */
+	virtual void notify(const yamm_event &event) = 0;
+
+	virtual ~yamm_observer() {
+	}
+};
+
+}
+#endif // __yamm_observer_h
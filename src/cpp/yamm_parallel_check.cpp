@@ -0,0 +1,573 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_parallel_check
+#define __yamm_parallel_check
+
+#include "yamm.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace yamm_ns {
+
+/** Number of buffers checked by one task when a memory map is split */
+#define YAMM_CHECK_CHUNK_SIZE 65536
+
+/**
+ * Counters of a memory map that is checked by more than one task
+ */
+class yamm_check_totals {
+public:
+	std::atomic<uint_64_t> number_of_buffers;
+	std::atomic<uint_64_t> number_of_free_buffers;
+	std::atomic<uint_64_t> used_bytes;
+	std::atomic<uint_64_t> free_bytes;
+	/** Number of free buffers for each log2 size class */
+	std::atomic<uint_64_t> free_histogram[64];
+	/** Number of tasks that didn't finish yet */
+	std::atomic<uint_64_t> remaining;
+
+	yamm_check_totals(uint_64_t tasks) :
+			number_of_buffers(0), number_of_free_buffers(0), used_bytes(0), free_bytes(
+					0), remaining(tasks) {
+		for (uint i = 0; i < 64; ++i)
+			free_histogram[i] = 0;
+	}
+};
+
+/**
+ * Statistics of the recursion levels below a memory map, summed up from the
+ * memory maps found by the tasks
+ */
+class yamm_check_levels {
+public:
+	/** Recursion level of the memory map */
+	uint level;
+	/** Entry i is for recursion level i below the memory map */
+	std::vector<yamm_statistics> levels;
+
+	yamm_check_levels() {
+		level = 0;
+	}
+};
+
+/**
+ * Part of a memory map to be checked by one of the threads
+ */
+class yamm_check_task {
+public:
+	/** Buffer that contains the memory map */
+	yamm_buffer* container;
+	/** First buffer to check, NULL if the memory map wasn't split yet */
+	yamm_buffer* start;
+	/** Number of buffers to check */
+	uint_64_t count;
+	/** Recursion level of the memory map */
+	uint level;
+	/** Counters shared by the tasks of a split memory map, NULL if not split */
+	yamm_check_totals* totals;
+};
+
+/**
+ * Checks a memory map and all the memory maps it contains using a pool of threads
+ * Used by yamm_buffer::check_address_space_consistency_parallel()
+ */
+class yamm_consistency_checker {
+
+	std::mutex lock;
+	std::condition_variable wake_up;
+	std::deque<yamm_check_task> tasks;
+	uint busy_threads;
+
+	std::mutex violations_lock;
+
+	std::mutex levels_lock;
+	std::map<yamm_buffer*, yamm_check_levels> levels;
+
+public:
+	std::vector<yamm_violation> violations;
+
+	yamm_consistency_checker() {
+		busy_threads = 0;
+	}
+
+	void push(const yamm_check_task &task) {
+		std::lock_guard<std::mutex> guard(lock);
+		tasks.push_back(task);
+		wake_up.notify_one();
+	}
+
+	void report(int kind, uint level, yamm_buffer* buffer, const char* message) {
+		std::lock_guard<std::mutex> guard(violations_lock);
+		violations.push_back(
+				yamm_violation(kind, level, buffer->start_addr,
+						buffer->end_addr, message));
+	}
+
+	/**
+	 * Checks a whole memory map or splits it in chunks if it's too big
+	 */
+	void check_map(yamm_check_task task) {
+
+		yamm_buffer* container = task.container;
+
+		if (container->is_slab()) {
+			check_slab(task);
+			return;
+		}
+
+		// The free buffers are looked up in the indexes
+		if (!container->container_state) {
+			report(YAMM_VIOLATION_INDEX, task.level, container,
+					"Memory map has no free buffer indexes");
+			return;
+		}
+
+		uint_64_t number_of_nodes = (uint_64_t) container->number_of_buffers
+				+ container->number_of_free_buffers;
+
+		if (number_of_nodes <= YAMM_CHECK_CHUNK_SIZE) {
+			task.start = container->first;
+			task.count = 0;
+			check_chunk(task);
+			return;
+		}
+
+		// Only follow the links to find where each chunk starts and push it right away,
+		// so the other threads check the chunks while the walk goes on. The walk holds
+		// one of the remaining tasks until it's done so the counters aren't compared early.
+		task.totals = new yamm_check_totals(1);
+		task.count = YAMM_CHECK_CHUNK_SIZE;
+
+		uint_64_t i = 0;
+		for (yamm_buffer* it = container->first; it; it = it->next, ++i)
+			if (i % YAMM_CHECK_CHUNK_SIZE == 0) {
+				task.totals->remaining++;
+				task.start = it;
+				push(task);
+			}
+
+		finish_part(task);
+	}
+
+	/**
+	 * Checks the slots of a slab against its bitmap and its counters
+	 */
+	void check_slab(const yamm_check_task &task) {
+
+		yamm_buffer* container = task.container;
+		yamm_container_state* state = container->container_state;
+		uint_64_t occupied = 0;
+
+		for (uint_64_t slot = 0; slot < state->slab_number_of_slots; ++slot) {
+
+			yamm_buffer* buffer = state->slab_slots[slot];
+			bool bit = (state->slab_bitmap[slot >> 6] >> (slot & 63)) & 1;
+
+			if ((buffer != NULL) != bit)
+				report(YAMM_VIOLATION_SLOT, task.level, buffer ? buffer : container,
+						"Slot doesn't match the bitmap");
+
+			if (!buffer)
+				continue;
+
+			occupied++;
+
+			if ((buffer->start_addr
+					!= container->start_addr + slot * state->slab_slot_size)
+					|| (buffer->size != state->slab_slot_size))
+				report(YAMM_VIOLATION_SLOT, task.level, buffer,
+						"Buffer doesn't cover its slot");
+
+			push_contained(buffer, task.level);
+		}
+
+		if (occupied != container->number_of_buffers)
+			report(YAMM_VIOLATION_COUNTER, task.level, container,
+					"Number of occupied slots doesn't match the counter");
+
+		// Each free slot is a free buffer, the bytes after the last slot are free too
+		yamm_statistics statistics;
+		statistics.used_bytes = occupied * state->slab_slot_size;
+		statistics.free_bytes = container->size - statistics.used_bytes;
+		statistics.number_of_buffers = occupied;
+		statistics.number_of_free_buffers = state->slab_number_of_slots
+				- occupied;
+		add_level_statistics(container, task.level, statistics);
+
+		// The bytes after the last slot are free too
+		if ((container->number_of_free_buffers
+				!= state->slab_number_of_slots - occupied)
+				|| (state->free_bytes
+						!= container->size - occupied * state->slab_slot_size))
+			report(YAMM_VIOLATION_COUNTER, task.level, container,
+					"Free slots don't match the counters");
+	}
+
+	/**
+	 * Pushes a task for the memory map or the slab inside an occupied buffer
+	 */
+	void push_contained(yamm_buffer* buffer, uint level) {
+
+		if ((!buffer->first) && (!buffer->is_slab()))
+			return;
+
+		yamm_check_task child;
+		child.container = buffer;
+		child.start = NULL;
+		child.count = 0;
+		child.level = level + 1;
+		child.totals = NULL;
+		push(child);
+	}
+
+	/**
+	 * Counts one task of a split memory map as done, the last one compares the counters
+	 */
+	void finish_part(const yamm_check_task &task) {
+
+		if (--task.totals->remaining != 0)
+			return;
+
+		yamm_statistics statistics;
+		statistics.used_bytes = task.totals->used_bytes;
+		statistics.free_bytes = task.totals->free_bytes;
+		statistics.number_of_buffers = task.totals->number_of_buffers;
+		statistics.number_of_free_buffers = task.totals->number_of_free_buffers;
+
+		std::vector<uint_64_t> histogram(64);
+		for (uint i = 0; i < 64; ++i)
+			histogram[i] = task.totals->free_histogram[i];
+
+		check_totals(task.container, task.level, statistics, histogram);
+		delete task.totals;
+	}
+
+	/**
+	 * Checks task.count buffers starting with task.start (all of them if count is 0)
+	 */
+	void check_chunk(const yamm_check_task &task) {
+
+		yamm_buffer* container = task.container;
+		yamm_container_state* state = container->container_state;
+		yamm_buffer* last_free = NULL;
+		yamm_buffer* buffer = task.start;
+
+		yamm_statistics statistics;
+		std::vector<uint_64_t> histogram(64, 0);
+
+		for (uint_64_t i = 0; buffer && (task.count == 0 || i < task.count);
+				++i, buffer = buffer->next) {
+
+			// Correct and strictly positive size
+			if ((buffer->size < 1)
+					|| (buffer->end_addr - buffer->start_addr + 1
+							!= buffer->size))
+				report(YAMM_VIOLATION_SIZE, task.level, buffer,
+						"Size doesn't match the start and end address");
+
+			// The first buffer starts at the start of the container
+			if (!buffer->prev) {
+				if ((container->first != buffer)
+						|| (buffer->start_addr != container->start_addr))
+					report(YAMM_VIOLATION_COVERAGE, task.level, buffer,
+							"First buffer doesn't start at the container's start address");
+			} else if (buffer->prev->next != buffer)
+				report(YAMM_VIOLATION_LINK, task.level, buffer,
+						"Previous buffer doesn't link back");
+
+			if (buffer->next) {
+
+				// Continuity
+				if (buffer->next->start_addr != buffer->end_addr + 1)
+					report(YAMM_VIOLATION_CONTINUITY, task.level, buffer,
+							"Next buffer doesn't start right after the end address");
+
+				if (buffer->next->prev != buffer)
+					report(YAMM_VIOLATION_LINK, task.level, buffer,
+							"Next buffer doesn't link back");
+
+				// Free buffers are merged
+				if ((buffer->is_free) && (buffer->next->is_free))
+					report(YAMM_VIOLATION_FREE_NOT_MERGED, task.level, buffer,
+							"Next buffer is also free");
+
+			} else if (buffer->end_addr != container->end_addr)
+				// The last buffer ends at the end of the container
+				report(YAMM_VIOLATION_COVERAGE, task.level, buffer,
+						"Last buffer doesn't end at the container's end address");
+
+			if (buffer->is_free) {
+
+				statistics.number_of_free_buffers++;
+				statistics.free_bytes += buffer->size;
+				histogram[63 - __builtin_clzll(buffer->size)]++;
+
+				// Only looked up, the indexes aren't changed while checking
+				std::map<uint_64_t, yamm_buffer*>::const_iterator by_addr =
+						state->free_by_addr.find(buffer->start_addr);
+				std::map<std::pair<uint_64_t, uint_64_t>, yamm_buffer*>::const_iterator by_size =
+						state->free_by_size.find(
+								std::make_pair(buffer->size,
+										buffer->start_addr));
+
+				if ((by_addr == state->free_by_addr.end())
+						|| (by_addr->second != buffer)
+						|| (by_size == state->free_by_size.end())
+						|| (by_size->second != buffer))
+					report(YAMM_VIOLATION_INDEX, task.level, buffer,
+							"Free buffer isn't indexed by address and by size");
+
+				// The free list has to contain all the free buffers, in order
+				if (last_free) {
+					if (last_free->next_free != buffer)
+						report(YAMM_VIOLATION_FREE_LINK, task.level, last_free,
+								"Next free buffer link skips a free buffer");
+				} else if (buffer->prev_free) {
+					if ((buffer->prev_free->next_free != buffer)
+							|| (buffer->prev_free->end_addr
+									>= buffer->start_addr))
+						report(YAMM_VIOLATION_FREE_LINK, task.level, buffer,
+								"Previous free buffer doesn't link back");
+				} else if (container->first_free != buffer)
+					report(YAMM_VIOLATION_FREE_LINK, task.level, buffer,
+							"First free buffer isn't first_free");
+
+				if ((buffer->next_free)
+						&& ((buffer->next_free->prev_free != buffer)
+								|| (buffer->next_free->start_addr
+										<= buffer->end_addr)))
+					report(YAMM_VIOLATION_FREE_LINK, task.level, buffer,
+							"Next free buffer doesn't link back");
+
+				last_free = buffer;
+
+			} else {
+
+				statistics.number_of_buffers++;
+				statistics.used_bytes += buffer->size;
+
+				// Contained memory maps and slabs are checked by other tasks
+				push_contained(buffer, task.level);
+			}
+		}
+
+		// Free buffers after the last free buffer of the chunk are checked by the other chunks
+		if ((last_free) && (!buffer) && (last_free->next_free))
+			report(YAMM_VIOLATION_FREE_LINK, task.level, last_free,
+					"Last free buffer has a next free buffer");
+
+		if (!task.totals) {
+			check_totals(container, task.level, statistics, histogram);
+			return;
+		}
+
+		task.totals->number_of_buffers += statistics.number_of_buffers;
+		task.totals->number_of_free_buffers +=
+				statistics.number_of_free_buffers;
+		task.totals->used_bytes += statistics.used_bytes;
+		task.totals->free_bytes += statistics.free_bytes;
+		for (uint i = 0; i < 64; ++i)
+			if (histogram[i])
+				task.totals->free_histogram[i] += histogram[i];
+
+		finish_part(task);
+	}
+
+	/**
+	 * Compares the counters and the indexes of a memory map with what its buffers add up to
+	 */
+	void check_totals(yamm_buffer* container, uint level,
+			const yamm_statistics &statistics,
+			const std::vector<uint_64_t> &histogram) {
+
+		yamm_container_state* state = container->container_state;
+
+		if ((statistics.number_of_buffers != container->number_of_buffers)
+				|| (statistics.number_of_free_buffers
+						!= container->number_of_free_buffers))
+			report(YAMM_VIOLATION_COUNTER, level, container,
+					"Number of buffers doesn't match the counters");
+
+		if (statistics.free_bytes != state->free_bytes)
+			report(YAMM_VIOLATION_COUNTER, level, container,
+					"Size of free buffers doesn't match the counter");
+
+		if ((statistics.number_of_free_buffers == 0) && (container->first_free))
+			report(YAMM_VIOLATION_FREE_LINK, level, container,
+					"No free buffers but first_free is set");
+
+		// Each free buffer was found in the indexes, so any other entry is stale
+		if ((state->free_by_addr.size() != statistics.number_of_free_buffers)
+				|| (state->free_by_size.size()
+						!= statistics.number_of_free_buffers))
+			report(YAMM_VIOLATION_INDEX, level, container,
+					"Free buffer indexes have stale entries");
+
+		bool histogram_matches = (state->free_histogram.size() == 64);
+		for (uint i = 0; (histogram_matches) && (i < 64); ++i)
+			histogram_matches = (state->free_histogram[i] == histogram[i]);
+
+		if (!histogram_matches)
+			report(YAMM_VIOLATION_INDEX, level, container,
+					"Free histogram doesn't match the free buffers");
+
+		add_level_statistics(container, level, statistics);
+	}
+
+	/**
+	 * Adds the statistics of a memory map to its container and to each buffer
+	 * that contains it, one recursion level deeper for each parent
+	 */
+	void add_level_statistics(yamm_buffer* container, uint level,
+			const yamm_statistics &statistics) {
+
+		std::lock_guard<std::mutex> guard(levels_lock);
+
+		yamm_buffer* buffer = container;
+		for (uint depth = 0; (buffer) && (depth <= level); ++depth) {
+
+			yamm_check_levels &sums = levels[buffer];
+			sums.level = level - depth;
+			if (sums.levels.size() <= depth)
+				sums.levels.resize(depth + 1);
+			sums.levels[depth].add(statistics);
+
+			buffer = buffer->parent;
+		}
+	}
+
+	/**
+	 * Compares the statistics kept by each memory map for the recursion levels below
+	 * it with the ones added up. Called once all the tasks are done.
+	 */
+	void check_level_statistics() {
+
+		std::map<yamm_buffer*, yamm_check_levels>::iterator it;
+		for (it = levels.begin(); it != levels.end(); ++it) {
+
+			yamm_buffer* container = it->first;
+			std::vector<yamm_statistics> &expected = it->second.levels;
+
+			bool matches = (expected.size() == container->get_number_of_levels());
+			for (uint level = 0; (matches) && (level < expected.size()); ++level) {
+				yamm_statistics actual = container->get_level_statistics(level);
+				matches = (expected[level].used_bytes == actual.used_bytes)
+						&& (expected[level].free_bytes == actual.free_bytes)
+						&& (expected[level].number_of_buffers
+								== actual.number_of_buffers)
+						&& (expected[level].number_of_free_buffers
+								== actual.number_of_free_buffers);
+			}
+
+			if (!matches)
+				report(YAMM_VIOLATION_INDEX, it->second.level, container,
+						"Statistics of the recursion levels don't match the buffers");
+		}
+	}
+
+	void worker() {
+
+		std::unique_lock<std::mutex> guard(lock);
+
+		while (1) {
+
+			while (tasks.empty() && busy_threads)
+				wake_up.wait(guard);
+
+			// Nothing left to do and nobody can add more
+			if (tasks.empty()) {
+				wake_up.notify_all();
+				return;
+			}
+
+			yamm_check_task task = tasks.front();
+			tasks.pop_front();
+			busy_threads++;
+			guard.unlock();
+
+			if (task.start)
+				check_chunk(task);
+			else
+				check_map(task);
+
+			guard.lock();
+			busy_threads--;
+			if (!busy_threads && tasks.empty())
+				wake_up.notify_all();
+		}
+	}
+
+};
+
+}
+
+using namespace yamm_ns;
+
+static bool yamm_violation_compare(const yamm_violation &a,
+		const yamm_violation &b) {
+	if (a.level != b.level)
+		return a.level < b.level;
+	if (a.start_addr != b.start_addr)
+		return a.start_addr < b.start_addr;
+	return a.kind < b.kind;
+}
+
+std::vector<yamm_violation> yamm_buffer::check_address_space_consistency_parallel(
+		uint number_of_threads) {
+
+	yamm_consistency_checker checker;
+
+	// Nothing was allocated inside yet
+	if ((!first) && (!is_slab()))
+		return checker.violations;
+
+	if (number_of_threads == 0)
+		number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	yamm_check_task task;
+	task.container = this;
+	task.start = NULL;
+	task.count = 0;
+	task.level = 0;
+	task.totals = NULL;
+	checker.push(task);
+
+	std::vector<std::thread> threads;
+	for (uint i = 1; i < number_of_threads; ++i)
+		threads.push_back(
+				std::thread(&yamm_consistency_checker::worker, &checker));
+
+	checker.worker();
+
+	for (uint i = 0; i < threads.size(); ++i)
+		threads[i].join();
+
+	checker.check_level_statistics();
+
+	std::sort(checker.violations.begin(), checker.violations.end(),
+			yamm_violation_compare);
+
+	return checker.violations;
+}
+
+#endif // __yamm_parallel_check
@@ -0,0 +1,36 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef __yamm_perf_counters
+#define __yamm_perf_counters
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+yamm_perf_counters yamm_buffer::perf_counters;
+
+yamm_perf_counters yamm_buffer::get_perf_counters() {
+	return perf_counters;
+}
+
+void yamm_buffer::reset_perf_counters() {
+	perf_counters.reset();
+}
+
+#endif // __yamm_perf_counters
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef __yamm_perf_counters_h
+#define __yamm_perf_counters_h
+
+namespace yamm_ns {
+
+#ifndef uint_64_t
+typedef unsigned long long int uint_64_t;
+#endif
+
+/** Number of allocation modes, one more than the last YAMM_*_FIT */
+#define YAMM_NUMBER_OF_MODES 10
+
+// The counters are only updated if YAMM_PERF_COUNTERS is defined, otherwise
+// the macros are empty and the hot paths are the same as without them
+#ifdef YAMM_PERF_COUNTERS
+#define YAMM_COUNT(counter) (yamm_buffer::perf_counters.counter++)
+#define YAMM_COUNT_N(counter, n) (yamm_buffer::perf_counters.counter += (n))
+#define YAMM_COUNT_MODE(counter, mode) \
+	do { \
+		if ((unsigned int) (mode) < YAMM_NUMBER_OF_MODES) \
+			yamm_buffer::perf_counters.counter[mode]++; \
+	} while (0)
+#else
+#define YAMM_COUNT(counter) ((void) 0)
+#define YAMM_COUNT_N(counter, n) ((void) 0)
+#define YAMM_COUNT_MODE(counter, mode) ((void) 0)
+#endif
+
+/**
+ * Class that counts the work done by the allocator, for all the memory maps.
+ * Only updated if the library is compiled with YAMM_PERF_COUNTERS defined.
+ */
+class yamm_perf_counters {
+public:
+
+	/** Searches for a place by allocate(), allocate_in_range() and resize(), by allocation mode */
+	uint_64_t lookups[YAMM_NUMBER_OF_MODES];
+	/** Searches that didn't find a place, by allocation mode */
+	uint_64_t failed_lookups[YAMM_NUMBER_OF_MODES];
+	/** Free buffers visited by the searches in the free list */
+	uint_64_t nodes_visited;
+	/** Searches that went past their first choice: random fit going around the random
+	 * buffer, next fit wrapping around and random address fit counting every start address */
+	uint_64_t fallbacks;
+	/** Allocations that left a free buffer before or after the allocated one */
+	uint_64_t splits;
+	/** Free buffers merged with a deallocated one */
+	uint_64_t merges;
+	/** Buffers deallocated */
+	uint_64_t deallocations;
+	/** Buffers looked up by address */
+	uint_64_t buffer_lookups;
+	/** Buffers visited by the lookups by address */
+	uint_64_t buffer_lookup_steps;
+
+	/**
+	 *	Performance counters constructor.
+	 *	All counters start from 0.
+	 */
+	yamm_perf_counters() {
+		reset();
+	}
+
+	/**
+	 *  Sets all the counters to 0
+	 */
+	void reset() {
+		for (unsigned int mode = 0; mode < YAMM_NUMBER_OF_MODES; ++mode) {
+			this->lookups[mode] = 0;
+			this->failed_lookups[mode] = 0;
+		}
+		this->nodes_visited = 0;
+		this->fallbacks = 0;
+		this->splits = 0;
+		this->merges = 0;
+		this->deallocations = 0;
+		this->buffer_lookups = 0;
+		this->buffer_lookup_steps = 0;
+	}
+
+};
+
+}
+#endif // __yamm_perf_counters_h
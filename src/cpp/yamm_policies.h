@@ -0,0 +1,356 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_policies_h
+#define __yamm_policies_h
+
+#include <stdlib.h>
+
+#include "yamm.h"
+
+namespace yamm_ns {
+
+/** Index used for "no extent" in the links */
+#define YAMM_NO_EXTENT 0xFFFFFFFFu
+
+/**
+ * Default random generator, based on rand() like the rest of YAMM so srand() seeds it
+ */
+class yamm_rand_rng {
+public:
+	/**
+	 * @return 64 random bits
+	 */
+	uint_64_t operator()() {
+		uint_64_t result = ((uint_64_t) rand()) << 32;
+		result |= rand();
+		return result;
+	}
+};
+
+/**
+ * Builds a random address from 64-bit draws, one draw for addresses up to 64 bits
+ */
+template<class AddrT, bool wide = (sizeof(AddrT) > 8)>
+class yamm_random_word {
+public:
+	template<class RNG>
+	static AddrT generate(RNG &rng) {
+		return (AddrT) rng();
+	}
+};
+
+/**
+ * Two draws for addresses wider than 64 bits
+ */
+template<class AddrT>
+class yamm_random_word<AddrT, true> {
+public:
+	template<class RNG>
+	static AddrT generate(RNG &rng) {
+		AddrT result = (AddrT) rng();
+		result = (result << 64) | (AddrT) rng();
+		return result;
+	}
+};
+
+// Search rules: each one returns a free extent that can hold size bytes with the
+// given alignment or YAMM_NO_EXTENT. Map is a yamm_basic_extent_map.
+
+/**
+ * The first free extent that fits, in address order
+ */
+class yamm_first_fit_search {
+public:
+	template<class Map, class RNG>
+	static uint_32_t find(Map &map, typename Map::addr_t size,
+			typename Map::addr_t alignment, RNG &rng) {
+
+		typename Map::addr_t aligned_addr;
+
+		for (uint_32_t extent = map.get_first_free(); extent != YAMM_NO_EXTENT;
+				extent = map.get_next_free(extent))
+			if (map.fits(extent, size, alignment, aligned_addr))
+				return extent;
+
+		return YAMM_NO_EXTENT;
+	}
+};
+
+/**
+ * The smallest free extent that fits, the first one of them in address order
+ */
+class yamm_best_fit_search {
+public:
+	template<class Map, class RNG>
+	static uint_32_t find(Map &map, typename Map::addr_t size,
+			typename Map::addr_t alignment, RNG &rng) {
+
+		typename Map::addr_t aligned_addr;
+		uint_32_t found = YAMM_NO_EXTENT;
+		typename Map::addr_t found_span = 0;
+
+		for (uint_32_t extent = map.get_first_free(); extent != YAMM_NO_EXTENT;
+				extent = map.get_next_free(extent)) {
+
+			typename Map::addr_t span = map.get_end_addr(extent)
+					- map.get_start_addr(extent);
+
+			if (((found == YAMM_NO_EXTENT) || (span < found_span))
+					&& (map.fits(extent, size, alignment, aligned_addr))) {
+				found = extent;
+				found_span = span;
+
+				// Can't get any better
+				if (span == size - 1)
+					break;
+			}
+		}
+
+		return found;
+	}
+};
+
+/**
+ * The largest free extent, the first one of them in address order
+ */
+class yamm_largest_fit_search {
+public:
+	template<class Map, class RNG>
+	static uint_32_t find(Map &map, typename Map::addr_t size,
+			typename Map::addr_t alignment, RNG &rng) {
+
+		typename Map::addr_t aligned_addr;
+		uint_32_t found = YAMM_NO_EXTENT;
+		typename Map::addr_t found_span = 0;
+
+		for (uint_32_t extent = map.get_first_free(); extent != YAMM_NO_EXTENT;
+				extent = map.get_next_free(extent)) {
+
+			typename Map::addr_t span = map.get_end_addr(extent)
+					- map.get_start_addr(extent);
+
+			if (((found == YAMM_NO_EXTENT) || (span > found_span))
+					&& (map.fits(extent, size, alignment, aligned_addr))) {
+				found = extent;
+				found_span = span;
+			}
+		}
+
+		return found;
+	}
+};
+
+/**
+ * A random free extent; if it doesn't fit, the closest one that fits going
+ * alternatively to the right and to the left
+ */
+class yamm_random_search {
+public:
+	template<class Map, class RNG>
+	static uint_32_t find(Map &map, typename Map::addr_t size,
+			typename Map::addr_t alignment, RNG &rng) {
+
+		typename Map::addr_t aligned_addr;
+
+		if (map.get_number_of_free_extents() == 0)
+			return YAMM_NO_EXTENT;
+
+		uint_32_t extent = map.get_first_free();
+		uint_32_t buffer_cnt = rng() % map.get_number_of_free_extents();
+		while (buffer_cnt--)
+			extent = map.get_next_free(extent);
+
+		if (map.fits(extent, size, alignment, aligned_addr))
+			return extent;
+
+		uint_32_t right = map.get_next_free(extent);
+		uint_32_t left = map.get_prev_free(extent);
+
+		while ((right != YAMM_NO_EXTENT) || (left != YAMM_NO_EXTENT)) {
+
+			if (right != YAMM_NO_EXTENT) {
+				if (map.fits(right, size, alignment, aligned_addr))
+					return right;
+				right = map.get_next_free(right);
+			}
+
+			if (left != YAMM_NO_EXTENT) {
+				if (map.fits(left, size, alignment, aligned_addr))
+					return left;
+				left = map.get_prev_free(left);
+			}
+		}
+
+		return YAMM_NO_EXTENT;
+	}
+};
+
+/**
+ * A free extent chosen with a probability proportional to the number of aligned
+ * start addresses where size bytes fit, so with yamm_random_placement every
+ * start address of the memory is equally likely
+ */
+class yamm_random_addr_search {
+public:
+	template<class Map, class RNG>
+	static uint_32_t find(Map &map, typename Map::addr_t size,
+			typename Map::addr_t alignment, RNG &rng) {
+
+		typename Map::addr_t aligned_addr;
+		typename Map::addr_t number_of_addrs = 0;
+
+		for (uint_32_t extent = map.get_first_free(); extent != YAMM_NO_EXTENT;
+				extent = map.get_next_free(extent))
+			if (map.fits(extent, size, alignment, aligned_addr))
+				number_of_addrs += (map.get_end_addr(extent) - (size - 1)
+						- aligned_addr) / alignment + 1;
+
+		// Wraps to 0 only for a full address space with alignment 1
+		typename Map::addr_t target = yamm_random_word<typename Map::addr_t>::generate(rng);
+		if (number_of_addrs != 0)
+			target = target % number_of_addrs;
+
+		uint_32_t found = YAMM_NO_EXTENT;
+
+		for (uint_32_t extent = map.get_first_free(); extent != YAMM_NO_EXTENT;
+				extent = map.get_next_free(extent)) {
+
+			if (!map.fits(extent, size, alignment, aligned_addr))
+				continue;
+
+			found = extent;
+			typename Map::addr_t addrs = (map.get_end_addr(extent) - (size - 1)
+					- aligned_addr) / alignment + 1;
+			if (target < addrs)
+				break;
+			target -= addrs;
+		}
+
+		return found;
+	}
+};
+
+// Placement rules: each one returns the start address inside a free extent
+// returned by a search rule.
+
+/**
+ * The lowest aligned address
+ */
+class yamm_lowest_placement {
+public:
+	template<class Map, class RNG>
+	static typename Map::addr_t place(Map &map, uint_32_t extent,
+			typename Map::addr_t size, typename Map::addr_t alignment,
+			RNG &rng) {
+
+		typename Map::addr_t first_addr = 0;
+		map.fits(extent, size, alignment, first_addr);
+		return first_addr;
+	}
+};
+
+/**
+ * Any aligned address where the buffer fits, all of them equally likely
+ */
+class yamm_random_placement {
+public:
+	template<class Map, class RNG>
+	static typename Map::addr_t place(Map &map, uint_32_t extent,
+			typename Map::addr_t size, typename Map::addr_t alignment,
+			RNG &rng) {
+
+		typename Map::addr_t first_addr = 0;
+		map.fits(extent, size, alignment, first_addr);
+
+		typename Map::addr_t slots = (map.get_end_addr(extent) - (size - 1)
+				- first_addr) / alignment;
+
+		if (slots == 0)
+			return first_addr;
+
+		// slots + 1 can only overflow for a full address space with alignment 1
+		typename Map::addr_t slot = yamm_random_word<typename Map::addr_t>::generate(rng);
+		if (slots + 1 != 0)
+			slot = slot % (slots + 1);
+
+		return first_addr + slot * alignment;
+	}
+};
+
+/**
+ * The aligned address closest to the middle of the free extent
+ */
+class yamm_middle_placement {
+public:
+	template<class Map, class RNG>
+	static typename Map::addr_t place(Map &map, uint_32_t extent,
+			typename Map::addr_t size, typename Map::addr_t alignment,
+			RNG &rng) {
+
+		typename Map::addr_t first_addr = 0;
+		map.fits(extent, size, alignment, first_addr);
+
+		// Last aligned address where size bytes still fit
+		typename Map::addr_t last_addr = map.get_end_addr(extent) - (size - 1);
+		last_addr = last_addr - (last_addr - first_addr) % alignment;
+
+		typename Map::addr_t middle = first_addr + (last_addr - first_addr) / 2;
+		typename Map::addr_t below = middle - (middle - first_addr) % alignment;
+		if ((middle - below > alignment / 2) && (below + alignment <= last_addr))
+			return below + alignment;
+		return below;
+	}
+};
+
+/**
+ * An allocation policy: a search rule and a placement rule, plus the equivalent
+ * YAMM allocation mode
+ */
+template<class Search, class Placement, int Mode>
+class yamm_policy {
+public:
+
+	static const int allocation_mode = Mode;
+
+	template<class Map, class RNG>
+	static uint_32_t find(Map &map, typename Map::addr_t size,
+			typename Map::addr_t alignment, RNG &rng) {
+		return Search::find(map, size, alignment, rng);
+	}
+
+	template<class Map, class RNG>
+	static typename Map::addr_t place(Map &map, uint_32_t extent,
+			typename Map::addr_t size, typename Map::addr_t alignment,
+			RNG &rng) {
+		return Placement::place(map, extent, size, alignment, rng);
+	}
+};
+
+// The policies of the YAMM allocation modes. YAMM_BUDDY_FIT, YAMM_TLSF_FIT and
+// YAMM_NEXT_FIT have none: they depend on state kept between allocations (the block
+// and class indexes, the rover) that a stateless policy can't hold.
+typedef yamm_policy<yamm_random_search, yamm_random_placement, YAMM_RANDOM_FIT> yamm_random_fit_policy;
+typedef yamm_policy<yamm_first_fit_search, yamm_random_placement, YAMM_FIRST_FIT_RND> yamm_first_fit_rnd_policy;
+typedef yamm_policy<yamm_best_fit_search, yamm_random_placement, YAMM_BEST_FIT_RND> yamm_best_fit_rnd_policy;
+typedef yamm_policy<yamm_first_fit_search, yamm_lowest_placement, YAMM_FIRST_FIT> yamm_first_fit_policy;
+typedef yamm_policy<yamm_best_fit_search, yamm_lowest_placement, YAMM_BEST_FIT> yamm_best_fit_policy;
+typedef yamm_policy<yamm_largest_fit_search, yamm_middle_placement, YAMM_UNIFORM_FIT> yamm_uniform_fit_policy;
+typedef yamm_policy<yamm_random_addr_search, yamm_random_placement, YAMM_RANDOM_ADDR_FIT> yamm_random_addr_fit_policy;
+
+}
+#endif // __yamm_policies_h
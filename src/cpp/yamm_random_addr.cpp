@@ -0,0 +1,200 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_random_addr
+#define __yamm_random_addr
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+/** Number of draws from free_space_tree before counting all the start addresses */
+#define YAMM_RANDOM_ADDR_DRAWS 32
+
+// A free buffer of size S that can hold a buffer of size s has at most
+// ceil((S - s + 1) / a) start addresses aligned to a, so (S - s + a) is at least a times
+// that. Drawing a free buffer with a weight of (S - s + a) and a number t below it, then
+// keeping t only if it is below a times the number of start addresses, makes every
+// start address equally likely. The weights only depend on the sizes, so their sums
+// over the free buffers of at least s bytes come from the subtree sums of the tree.
+
+uint_64_t yamm_buffer::count_start_addrs(yamm_buffer* free_buffer,
+		uint_64_t size, uint_64_t alignment, uint_64_t alignment_mask,
+		uint_64_t &first_addr) {
+
+	if (size > free_buffer->size)
+		return 0;
+
+	// Last start address where size bytes fit
+	uint_64_t last_addr = free_buffer->end_addr - (size - 1);
+
+	first_addr = free_buffer->start_addr;
+	if (alignment_mask != YAMM_NO_MASK)
+		first_addr += (0 - first_addr) & alignment_mask;
+	else
+		first_addr += (alignment - first_addr % alignment) % alignment;
+
+	if ((first_addr < free_buffer->start_addr) || (first_addr > last_addr))
+		return 0;
+
+	if (alignment_mask != YAMM_NO_MASK)
+		return ((last_addr - first_addr) >> __builtin_ctzll(alignment)) + 1;
+
+	return (last_addr - first_addr) / alignment + 1;
+}
+
+bool yamm_buffer::allocate_random_addr(yamm_buffer* new_buffer) {
+
+	uint_64_t size = new_buffer->size;
+	uint_64_t alignment = new_buffer->start_addr_alignment;
+	uint_64_t alignment_mask = new_buffer->start_addr_alignment_mask;
+
+	init_free_buffer();
+
+	// The first allocation in this mode builds the tree, after that it is kept
+	// up to date by index_free_buffer() and unindex_free_buffer()
+	if (!container_state->free_space_tree) {
+		container_state->free_space_tree = new yamm_free_space_tree;
+		for (std::map<std::pair<uint_64_t, uint_64_t>, yamm_buffer*>::iterator it =
+				container_state->free_by_size.begin();
+				it != container_state->free_by_size.end(); ++it)
+			container_state->free_space_tree->insert(*it);
+	}
+
+	std::pair<uint_64_t, uint_64_t> smallest(size, 0);
+	yamm_free_space_tree::node_iterator end_node =
+			container_state->free_space_tree->node_end();
+	yamm_free_space_tree::node_iterator node;
+
+	// Total size and number of the free buffers of at least size bytes
+	uint_64_t total_size = 0;
+	uint_64_t count = 0;
+
+	node = container_state->free_space_tree->node_begin();
+	while (node != end_node) {
+
+		if ((*node)->first < smallest) {
+			node = node.get_r_child();
+			continue;
+		}
+
+		total_size += (*node)->first.first;
+		count++;
+
+		yamm_free_space_tree::node_iterator right = node.get_r_child();
+		if (right != end_node) {
+			total_size += right.get_metadata().first;
+			count += right.get_metadata().second;
+		}
+
+		node = node.get_l_child();
+	}
+
+	if (count == 0)
+		return 0;
+
+	// Each size is at least size so (total_size - count * size) can't overflow, the
+	// alignments added can and then only the exact search below is used
+	uint_64_t total_weight;
+	uint_64_t total_alignment;
+	bool overflow = __builtin_mul_overflow(count, alignment, &total_alignment)
+			|| __builtin_add_overflow(total_size - count * size,
+					total_alignment, &total_weight);
+
+	for (uint draw = 0; (!overflow) && (draw < YAMM_RANDOM_ADDR_DRAWS);
+			++draw) {
+
+		uint_64_t target = generate_rand64() % total_weight;
+
+		// Go through the free buffers of at least size bytes from the largest one
+		node = container_state->free_space_tree->node_begin();
+		while (1) {
+
+			if ((*node)->first < smallest) {
+				node = node.get_r_child();
+				continue;
+			}
+
+			yamm_free_space_tree::node_iterator right = node.get_r_child();
+			if (right != end_node) {
+				uint_64_t right_weight = right.get_metadata().first
+						- right.get_metadata().second * size
+						+ right.get_metadata().second * alignment;
+				if (target < right_weight) {
+					node = right;
+					continue;
+				}
+				target -= right_weight;
+			}
+
+			uint_64_t weight = (*node)->first.first - size + alignment;
+			if (target < weight)
+				break;
+
+			target -= weight;
+			node = node.get_l_child();
+		}
+
+		yamm_buffer* free_buffer = (*node)->second;
+		uint_64_t first_addr;
+		uint_64_t number_of_addrs = count_start_addrs(free_buffer, size,
+				alignment, alignment_mask, first_addr);
+
+		if (target < number_of_addrs * alignment) {
+			new_buffer->start_addr = first_addr + (target / alignment) * alignment;
+			new_buffer->end_addr = new_buffer->start_addr + size - 1;
+			add(new_buffer, free_buffer);
+			return 1;
+		}
+	}
+
+	// Too many draws were rejected, count the start addresses of each free buffer
+	YAMM_COUNT(fallbacks);
+	uint_64_t first_addr;
+	uint_64_t total_addrs = 0;
+	std::map<std::pair<uint_64_t, uint_64_t>, yamm_buffer*>::iterator it;
+
+	for (it = container_state->free_by_size.lower_bound(smallest);
+			it != container_state->free_by_size.end(); ++it)
+		total_addrs += count_start_addrs(it->second, size, alignment,
+				alignment_mask, first_addr);
+
+	if (total_addrs == 0)
+		return 0;
+
+	uint_64_t target = generate_rand64() % total_addrs;
+
+	for (it = container_state->free_by_size.lower_bound(smallest);
+			it != container_state->free_by_size.end(); ++it) {
+
+		uint_64_t number_of_addrs = count_start_addrs(it->second, size,
+				alignment, alignment_mask, first_addr);
+
+		if (target < number_of_addrs) {
+			new_buffer->start_addr = first_addr + target * alignment;
+			new_buffer->end_addr = new_buffer->start_addr + size - 1;
+			add(new_buffer, it->second);
+			return 1;
+		}
+
+		target -= number_of_addrs;
+	}
+
+	return 0;
+}
+
+#endif // __yamm_random_addr
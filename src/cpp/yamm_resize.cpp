@@ -0,0 +1,134 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_resize
+#define __yamm_resize
+
+#include "yamm.h"
+#include <string.h>
+
+using namespace yamm_ns;
+
+void yamm_buffer::resize_contents(uint_64_t old_size) {
+
+	if (!contents)
+		return;
+
+	char* new_contents = new char[size];
+	memcpy(new_contents, contents, std::min(old_size, size));
+
+	// The bytes added at the end are random, like generate_random_contents()
+	for (uint_64_t i = old_size; i < size; ++i)
+		new_contents[i] = rand() % 256;
+
+	delete[] contents;
+	contents = new_contents;
+}
+
+bool yamm_buffer::resize(yamm_buffer* buffer, uint_64_t new_size,
+		int allocation_mode) {
+
+	if ((!buffer) || (buffer->is_free) || (buffer->parent != this)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer is not allocated in this memory!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	if (new_size == 0) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer with size 0!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	// The memory map inside the buffer would have to be resized too
+	if ((buffer->first) || (buffer->is_slab())) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Can't resize buffers with children!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	new_size = compute_size_with_gran(new_size, buffer->granularity,
+			buffer->granularity_mask);
+
+	// A slot always takes the whole slot size
+	if (is_slab()) {
+		if (new_size <= container_state->slab_slot_size)
+			return 1;
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer of size %llu doesn't fit in a slot of %llu!\n\t in %s at line %d\n",
+					new_size, container_state->slab_slot_size, __FILE__, __LINE__);
+		return 0;
+	}
+
+	if (new_size == buffer->size)
+		return 1;
+
+	uint_64_t old_start_addr = buffer->start_addr;
+	uint_64_t old_size = buffer->size;
+
+	// Free the buffer, merging it with the free buffers next to it, then place it again:
+	// a smaller buffer leaves its tail free and a larger one takes the free space after it
+	yamm_buffer* merged_free = release(buffer);
+
+	buffer->next = NULL;
+	buffer->prev = NULL;
+	buffer->next_free = NULL;
+	buffer->prev_free = NULL;
+	buffer->size = new_size;
+
+	if ((new_size - 1 <= merged_free->end_addr - old_start_addr)) {
+		buffer->end_addr = old_start_addr + new_size - 1;
+		add(buffer, merged_free);
+		buffer->resize_contents(old_size);
+
+		notify(YAMM_EVENT_RESIZE, buffer, YAMM_NO_MODE, old_start_addr,
+				old_start_addr + old_size - 1);
+		return 1;
+	}
+
+	// As a last resort the buffer is moved, unless its address has to stay the same
+	if (is_movable(buffer)) {
+		YAMM_COUNT_MODE(lookups, allocation_mode);
+
+		if (place(buffer, allocation_mode)) {
+			buffer->resize_contents(old_size);
+
+			notify(YAMM_EVENT_RESIZE, buffer, allocation_mode, old_start_addr,
+					old_start_addr + old_size - 1);
+			return 1;
+		}
+
+		YAMM_COUNT_MODE(failed_lookups, allocation_mode);
+	}
+
+	// Put it back where it was
+	buffer->size = old_size;
+	buffer->start_addr = old_start_addr;
+	buffer->end_addr = old_start_addr + old_size - 1;
+	add(buffer, merged_free);
+
+	return 0;
+}
+
+#endif // __yamm_resize
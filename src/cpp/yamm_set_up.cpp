@@ -33,12 +33,17 @@ yamm_buffer::yamm_buffer() {
 
 	this->granularity = 1;
 	this->start_addr_alignment = 1;
+	this->granularity_mask = 0;
+	this->start_addr_alignment_mask = 0;
 
 	this->is_free = 0;
 	this->is_static = 0;
+	this->is_inserted = 0;
 
 	this->number_of_buffers = 0;
 	this->number_of_free_buffers = 1;
+	this->tlsf_next = NULL;
+	this->tlsf_prev = NULL;
 
 	this->next_free = NULL;
 	this->prev_free = NULL;
@@ -47,6 +52,8 @@ yamm_buffer::yamm_buffer() {
 
 	this->first_free = NULL;
 	this->first = NULL;
+	this->parent = NULL;
+	this->container_state = NULL;
 
 	this->contents = NULL;
 	this->name = "";
@@ -68,12 +75,17 @@ yamm_buffer::yamm_buffer(uint_64_t size) {
 
 	this->granularity = 1;
 	this->start_addr_alignment = 1;
+	this->granularity_mask = 0;
+	this->start_addr_alignment_mask = 0;
 
 	this->is_free = 0;
 	this->is_static = 0;
+	this->is_inserted = 0;
 
 	this->number_of_buffers = 0;
 	this->number_of_free_buffers = 1;
+	this->tlsf_next = NULL;
+	this->tlsf_prev = NULL;
 
 	this->next_free = NULL;
 	this->prev_free = NULL;
@@ -82,6 +94,8 @@ yamm_buffer::yamm_buffer(uint_64_t size) {
 
 	this->first_free = NULL;
 	this->first = NULL;
+	this->parent = NULL;
+	this->container_state = NULL;
 
 	this->contents = NULL;
 
@@ -105,9 +119,12 @@ yamm_buffer::yamm_buffer(yamm_buffer* n) {
 
 	this->is_free = n->is_free;
 	this->is_static = n->is_static;
+	this->is_inserted = n->is_inserted;
 
 	this->number_of_buffers = n->number_of_buffers;
 	this->number_of_free_buffers = n->number_of_free_buffers;
+	this->tlsf_next = NULL;
+	this->tlsf_prev = NULL;
 
 	this->next_free = NULL;
 	this->prev_free = NULL;
@@ -116,6 +133,8 @@ yamm_buffer::yamm_buffer(yamm_buffer* n) {
 
 	this->first_free = NULL;
 	this->first = NULL;
+	this->parent = NULL;
+	this->container_state = NULL;
 
 	this->contents = NULL;
 
@@ -127,6 +146,9 @@ yamm_buffer::yamm_buffer(yamm_buffer* n) {
 	if (this->start_addr_alignment == 0)
 		this->start_addr_alignment = 1;
 
+	this->granularity_mask = compute_mask(this->granularity);
+	this->start_addr_alignment_mask = compute_mask(this->start_addr_alignment);
+
 	this->disable_warnings = 0;
 	this->disable_info = 0;
 
@@ -143,12 +165,17 @@ yamm_buffer::yamm_buffer(uint_64_t start, uint_64_t size) {
 
 	this->granularity = 1;
 	this->start_addr_alignment = 1;
+	this->granularity_mask = 0;
+	this->start_addr_alignment_mask = 0;
 
 	this->is_free = 0;
 	this->is_static = 0;
+	this->is_inserted = 0;
 
 	this->number_of_buffers = 0;
 	this->number_of_free_buffers = 1;
+	this->tlsf_next = NULL;
+	this->tlsf_prev = NULL;
 
 	this->next_free = NULL;
 	this->prev_free = NULL;
@@ -157,6 +184,8 @@ yamm_buffer::yamm_buffer(uint_64_t start, uint_64_t size) {
 
 	this->first_free = NULL;
 	this->first = NULL;
+	this->parent = NULL;
+	this->container_state = NULL;
 
 	this->contents = NULL;
 	this->name = "";
@@ -176,12 +205,17 @@ yamm_buffer::yamm_buffer(std::string name) {
 
 	this->granularity = 1;
 	this->start_addr_alignment = 1;
+	this->granularity_mask = 0;
+	this->start_addr_alignment_mask = 0;
 
 	this->is_free = 0;
 	this->is_static = 0;
+	this->is_inserted = 0;
 
 	this->number_of_buffers = 0;
 	this->number_of_free_buffers = 1;
+	this->tlsf_next = NULL;
+	this->tlsf_prev = NULL;
 
 	this->next_free = NULL;
 	this->prev_free = NULL;
@@ -190,6 +224,8 @@ yamm_buffer::yamm_buffer(std::string name) {
 
 	this->first_free = NULL;
 	this->first = NULL;
+	this->parent = NULL;
+	this->container_state = NULL;
 
 	this->contents = NULL;
 	this->name = name;
@@ -210,12 +246,17 @@ yamm_buffer::yamm_buffer(uint_64_t size, std::string name) {
 
 	this->granularity = 1;
 	this->start_addr_alignment = 1;
+	this->granularity_mask = 0;
+	this->start_addr_alignment_mask = 0;
 
 	this->is_free = 0;
 	this->is_static = 0;
+	this->is_inserted = 0;
 
 	this->number_of_buffers = 0;
 	this->number_of_free_buffers = 1;
+	this->tlsf_next = NULL;
+	this->tlsf_prev = NULL;
 
 	this->next_free = NULL;
 	this->prev_free = NULL;
@@ -224,6 +265,8 @@ yamm_buffer::yamm_buffer(uint_64_t size, std::string name) {
 
 	this->first_free = NULL;
 	this->first = NULL;
+	this->parent = NULL;
+	this->container_state = NULL;
 
 	this->contents = NULL;
 	this->name = name;
@@ -262,6 +305,16 @@ yamm_buffer::~yamm_buffer() {
 		this->first_free = NULL;
 	}
 
+	if (is_slab())
+		for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots;
+				++slot)
+			delete container_state->slab_slots[slot];
+
+	set_observer(NULL);
+
+	delete container_state;
+	container_state = NULL;
+
 	this->next = NULL;
 	this->prev = NULL;
 	this->next_free = NULL;
@@ -290,6 +343,9 @@ yamm::~yamm() {
 	this->disable_info = 1;
 	this->disable_warnings = 1;
 
+	// The observer isn't told about the buffers deleted with the memory
+	set_observer(NULL);
+
 	if (this->first) {
 		this->hard_reset();
 		delete this->first;
@@ -329,6 +385,8 @@ void yamm::build(uint_64_t size) {
 		mem->set_start_addr(0);
 		mem->set_size(size);
 
+		index_free_buffer(mem);
+
 	}
 }
 
@@ -337,6 +395,8 @@ void yamm_buffer::hard_reset() {
 	yamm_buffer* it = this->first;
 	yamm_buffer* del;
 
+	notify(YAMM_EVENT_HARD_RESET, NULL, YAMM_NO_MODE, 0, 0);
+
 	it = this->first;
 
 	bool warnings = this->disable_warnings;
@@ -345,12 +405,29 @@ void yamm_buffer::hard_reset() {
 	this->disable_warnings = 1;
 	this->disable_info = 1;
 
+	// The slots of a slab aren't linked in the list
+	if (is_slab())
+		for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots;
+				++slot) {
+
+			del = container_state->slab_slots[slot];
+			if (!del)
+				continue;
+
+			if ((del->first) || (del->is_slab())) {
+				del->hard_reset();
+			}
+
+			del->is_static = 0;
+			deallocate(del);
+		}
+
 	while (it) {
 
 		del = it;
 		it = it->next;
 
-		if (del->first) {
+		if ((del->first) || (del->is_slab())) {
 			del->hard_reset();
 		}
 
@@ -379,18 +456,37 @@ void yamm_buffer::soft_reset() {
 	yamm_buffer* it = this->first;
 	yamm_buffer* del;
 
+	notify(YAMM_EVENT_SOFT_RESET, NULL, YAMM_NO_MODE, 0, 0);
+
 	bool warnings = this->disable_warnings;
 	bool infos = this->disable_info;
 
 	this->disable_warnings = 1;
 	this->disable_info = 1;
 
+	// The slots of a slab aren't linked in the list
+	if (is_slab())
+		for (uint_64_t slot = 0; slot < container_state->slab_number_of_slots;
+				++slot) {
+
+			del = container_state->slab_slots[slot];
+			if (!del)
+				continue;
+
+			if ((del->first) || (del->is_slab())) {
+				del->soft_reset();
+			}
+
+			if (!del->is_static)
+				deallocate(del);
+		}
+
 	while (it) {
 
 		del = it;
 		it = it->next;
 
-		if (del->first) {
+		if ((del->first) || (del->is_slab())) {
 			del->soft_reset();
 		}
 
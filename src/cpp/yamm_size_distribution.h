@@ -0,0 +1,116 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_size_distribution_h
+#define __yamm_size_distribution_h
+
+#include <stdlib.h>
+#include <vector>
+
+namespace yamm_ns {
+
+#ifndef uint_64_t
+typedef unsigned long long int uint_64_t;
+#endif
+
+/**
+ * Class that draws the sizes of the buffers allocated by yamm_buffer::populate().
+ * By default the sizes are uniform in [min_size, max_size]. Once add_size() is called
+ * only the sizes added are drawn, each one in proportion to its weight.
+ *
+ * next_size() can be overwritten by user for other distributions.
+ * Like the rest of YAMM it is based on rand() so srand() seeds it.
+ */
+class yamm_size_distribution {
+protected:
+
+	/** Smallest size drawn by default */
+	uint_64_t min_size;
+	/** Largest size drawn by default */
+	uint_64_t max_size;
+	/** (size, cumulated weight) for each size added */
+	std::vector<std::pair<uint_64_t, uint_64_t> > weighted_sizes;
+
+	/**
+	 *  Generates a random unsigned int64
+	 */
+	static uint_64_t generate_rand64() {
+		uint_64_t result = ((uint_64_t) rand()) << 32;
+		result |= rand();
+		return result;
+	}
+
+public:
+
+	/**
+	 * @param min_size Smallest size
+	 * @param max_size Largest size
+	 */
+	yamm_size_distribution(uint_64_t min_size, uint_64_t max_size) {
+		this->min_size = min_size;
+		this->max_size = (max_size < min_size) ? min_size : max_size;
+	}
+
+	/**
+	 *  Adds a size that is drawn in proportion to weight, instead of the uniform sizes
+	 *
+	 *  @param size The size
+	 *  @param weight Its relative frequency, 0 is ignored
+	 */
+	void add_size(uint_64_t size, uint_64_t weight) {
+
+		if (weight == 0)
+			return;
+
+		uint_64_t total = weighted_sizes.empty() ? 0 : weighted_sizes.back().second;
+		weighted_sizes.push_back(std::make_pair(size, total + weight));
+	}
+
+	/**
+	 *  Returns the size of the next buffer
+	 */
+	virtual uint_64_t next_size() {
+
+		if (weighted_sizes.empty()) {
+			uint_64_t range = max_size - min_size + 1;
+			// The whole uint_64_t range wraps to 0
+			return min_size + (range ? generate_rand64() % range : generate_rand64());
+		}
+
+		uint_64_t target = generate_rand64() % weighted_sizes.back().second;
+
+		// First size whose cumulated weight is above target
+		uint lo = 0;
+		uint hi = weighted_sizes.size() - 1;
+		while (lo < hi) {
+			uint mid = (lo + hi) / 2;
+			if (weighted_sizes[mid].second > target)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+
+		return weighted_sizes[lo].first;
+	}
+
+	virtual ~yamm_size_distribution() {
+	}
+
+};
+
+}
+#endif // __yamm_size_distribution_h
@@ -0,0 +1,305 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_slab
+#define __yamm_slab
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+bool yamm_buffer::make_slab(uint_64_t slot_size) {
+
+	if (is_slab()) {
+
+		if (number_of_buffers) {
+			if (!disable_warnings)
+				fprintf(stderr,
+						"[YAMM_WRN] Slab has occupied slots!\n\t in %s at line %d\n",
+						__FILE__, __LINE__);
+			return 0;
+		}
+
+		// Back to a regular buffer with nothing inside
+		yamm_statistics delta;
+		delta.free_bytes = container_state->free_bytes;
+		delta.number_of_free_buffers = number_of_free_buffers;
+		update_statistics(delta, 0, 0);
+
+		std::vector<uint_64_t>().swap(container_state->slab_bitmap);
+		std::vector<yamm_buffer*>().swap(container_state->slab_slots);
+		container_state->slab_slot_size = 0;
+		container_state->slab_number_of_slots = 0;
+		container_state->slab_hint = 0;
+		container_state->free_bytes = 0;
+		number_of_free_buffers = 1;
+	}
+
+	if (slot_size == 0)
+		return 1;
+
+	if ((is_free) || (first)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Only an occupied buffer with nothing inside can be a slab!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	if (slot_size > size) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Slot size %llu is larger than the buffer!\n\t in %s at line %d\n",
+					slot_size, __FILE__, __LINE__);
+		return 0;
+	}
+
+	yamm_container_state* state = get_container_state();
+
+	state->slab_slot_size = slot_size;
+	state->slab_number_of_slots = size / slot_size;
+	state->slab_bitmap.assign((state->slab_number_of_slots + 63) / 64, 0);
+	state->slab_slots.assign(state->slab_number_of_slots, NULL);
+	state->slab_hint = 0;
+
+	// Each slot is a free buffer, the bytes after the last slot are free but can't be used
+	state->free_bytes = size;
+	number_of_free_buffers = state->slab_number_of_slots;
+
+	yamm_statistics delta;
+	delta.free_bytes = state->free_bytes;
+	delta.number_of_free_buffers = number_of_free_buffers;
+	update_statistics(delta, 0, 1);
+
+	return 1;
+}
+
+uint_64_t yamm_buffer::find_slot(uint_64_t first_slot, uint_64_t last_slot,
+		bool is_free) {
+
+	uint_64_t last_word = last_slot >> 6;
+
+	for (uint_64_t word = first_slot >> 6; word <= last_word; ++word) {
+
+		uint_64_t bits = container_state->slab_bitmap[word];
+		if (is_free)
+			bits = ~bits;
+
+		// Only the slots inside [first_slot, last_slot]
+		if (word == (first_slot >> 6))
+			bits &= ~0ull << (first_slot & 63);
+		if ((word == last_word) && ((last_slot & 63) != 63))
+			bits &= (2ull << (last_slot & 63)) - 1;
+
+		if (bits)
+			return (word << 6) + __builtin_ctzll(bits);
+	}
+
+	return YAMM_NO_SLOT;
+}
+
+bool yamm_buffer::allocate_slot(yamm_buffer* new_buffer, int allocation_mode,
+		uint_64_t first_slot, uint_64_t last_slot) {
+
+	// Slots aren't linked so check_new_buffer() can't see a buffer that is already in a slab
+	if (new_buffer->parent) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer is already linked in memory!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	if (new_buffer->size > container_state->slab_slot_size) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer of size %llu doesn't fit in a slot of %llu!\n\t in %s at line %d\n",
+					new_buffer->size, container_state->slab_slot_size, __FILE__, __LINE__);
+		return 0;
+	}
+
+	// All the slots have the same alignment
+	uint_64_t alignment = new_buffer->start_addr_alignment;
+	if ((start_addr % alignment) || (container_state->slab_slot_size % alignment)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Alignment %llu doesn't divide the slots!\n\t in %s at line %d\n",
+					alignment, __FILE__, __LINE__);
+		return 0;
+	}
+
+	if ((first_slot > last_slot) || (number_of_free_buffers == 0))
+		return 0;
+
+	uint_64_t slot;
+
+	switch (allocation_mode) {
+	case YAMM_RANDOM_FIT ... YAMM_BEST_FIT_RND:
+	case YAMM_RANDOM_ADDR_FIT: {
+		// Scan from a random slot and wrap around
+		uint_64_t start_slot = first_slot
+				+ generate_rand64() % (last_slot - first_slot + 1);
+		slot = find_slot(start_slot, last_slot, 1);
+		if ((slot == YAMM_NO_SLOT) && (start_slot > first_slot))
+			slot = find_slot(first_slot, start_slot - 1, 1);
+		break;
+	}
+	default:
+		if ((first_slot >> 6) < container_state->slab_hint)
+			first_slot = container_state->slab_hint << 6;
+		if (first_slot > last_slot)
+			return 0;
+		slot = find_slot(first_slot, last_slot, 1);
+
+		// Everything before the slot that was found is occupied
+		if ((slot != YAMM_NO_SLOT) && (first_slot == container_state->slab_hint << 6))
+			container_state->slab_hint = slot >> 6;
+		break;
+	}
+
+	if (slot == YAMM_NO_SLOT)
+		return 0;
+
+	occupy_slot(new_buffer, slot);
+	return 1;
+}
+
+void yamm_buffer::occupy_slot(yamm_buffer* new_buffer, uint_64_t slot) {
+
+	// The buffer takes the whole slot, like the size is rounded up to the granularity
+	new_buffer->start_addr = start_addr + slot * container_state->slab_slot_size;
+	new_buffer->size = container_state->slab_slot_size;
+	new_buffer->end_addr = new_buffer->start_addr + container_state->slab_slot_size - 1;
+	new_buffer->parent = this;
+
+	container_state->slab_bitmap[slot >> 6] |= 1ull << (slot & 63);
+	container_state->slab_slots[slot] = new_buffer;
+
+	number_of_buffers++;
+	number_of_free_buffers--;
+	container_state->free_bytes -= container_state->slab_slot_size;
+
+	yamm_statistics delta;
+	delta.used_bytes = container_state->slab_slot_size;
+	delta.number_of_buffers = 1;
+	update_statistics(delta, 0, 1);
+
+	// An inserted buffer can bring its own memory maps
+	for (uint level = 0; level < new_buffer->get_number_of_levels(); ++level)
+		update_statistics(new_buffer->container_state->level_statistics[level],
+				level + 1, 1);
+
+	yamm_statistics free_delta;
+	free_delta.free_bytes = container_state->slab_slot_size;
+	free_delta.number_of_free_buffers = 1;
+	update_statistics(free_delta, 0, 0);
+}
+
+bool yamm_buffer::insert_slot(yamm_buffer* new_buffer) {
+
+	if (new_buffer->parent) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer is already in the memory!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	if ((new_buffer->start_addr < start_addr)
+			|| (new_buffer->start_addr > end_addr)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer is not in the slab!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	uint_64_t offset = new_buffer->start_addr - start_addr;
+	uint_64_t slot = offset / container_state->slab_slot_size;
+
+	if ((offset % container_state->slab_slot_size)
+			|| (slot >= container_state->slab_number_of_slots)
+			|| (new_buffer->size == 0)
+			|| (new_buffer->size > container_state->slab_slot_size)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer [%llx, +%llx] doesn't match a slot!\n\t in %s at line %d\n",
+					new_buffer->start_addr, new_buffer->size, __FILE__, __LINE__);
+		return 0;
+	}
+
+	if (container_state->slab_slots[slot])
+		return 0;
+
+	occupy_slot(new_buffer, slot);
+	new_buffer->is_inserted = 1;
+
+	notify(YAMM_EVENT_INSERT, new_buffer, YAMM_NO_MODE, 0, 0);
+	return 1;
+}
+
+bool yamm_buffer::deallocate_slot(yamm_buffer* del) {
+
+	uint_64_t slot = YAMM_NO_SLOT;
+
+	if ((del->start_addr >= start_addr) && (del->start_addr <= end_addr))
+		slot = (del->start_addr - start_addr) / container_state->slab_slot_size;
+
+	if ((slot >= container_state->slab_number_of_slots)
+			|| (container_state->slab_slots[slot] != del)) {
+		if (!disable_warnings)
+			fprintf(stderr,
+					"[YAMM_WRN] Buffer is not linked anywhere!\n\t in %s at line %d\n",
+					__FILE__, __LINE__);
+		return 0;
+	}
+
+	container_state->slab_bitmap[slot >> 6] &= ~(1ull << (slot & 63));
+	container_state->slab_slots[slot] = NULL;
+
+	if ((slot >> 6) < container_state->slab_hint)
+		container_state->slab_hint = slot >> 6;
+
+	number_of_buffers--;
+	number_of_free_buffers++;
+	container_state->free_bytes += container_state->slab_slot_size;
+
+	yamm_statistics free_delta;
+	free_delta.free_bytes = container_state->slab_slot_size;
+	free_delta.number_of_free_buffers = 1;
+	update_statistics(free_delta, 0, 1);
+
+	yamm_statistics delta;
+	delta.used_bytes = container_state->slab_slot_size;
+	delta.number_of_buffers = 1;
+	update_statistics(delta, 0, 0);
+
+	// The memory maps contained by the deallocated buffer are deleted with it
+	for (uint level = del->get_number_of_levels(); level > 0; --level)
+		update_statistics(del->container_state->level_statistics[level - 1],
+				level, 0);
+
+	notify(YAMM_EVENT_DEALLOCATE, del, YAMM_NO_MODE, del->start_addr,
+			del->end_addr);
+
+	YAMM_COUNT(deallocations);
+	delete del;
+
+	return 1;
+}
+
+#endif // __yamm_slab
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_statistics_h
+#define __yamm_statistics_h
+
+namespace yamm_ns {
+
+#ifndef uint_64_t
+typedef unsigned long long int uint_64_t;
+#endif
+
+/**
+ * Class that holds the statistics of one or more memory maps
+ * (the list of buffers contained by a buffer)
+ */
+class yamm_statistics {
+public:
+
+	/** Total size of the occupied buffers */
+	uint_64_t used_bytes;
+	/** Total size of the free buffers */
+	uint_64_t free_bytes;
+	/** Number of occupied buffers */
+	uint_64_t number_of_buffers;
+	/** Number of free buffers */
+	uint_64_t number_of_free_buffers;
+
+	/**
+	 *	Statistics constructor.
+	 *	All counters start from 0.
+	 */
+	yamm_statistics() {
+		this->used_bytes = 0;
+		this->free_bytes = 0;
+		this->number_of_buffers = 0;
+		this->number_of_free_buffers = 0;
+	}
+
+	/**
+	 *  Adds the counters of another set of statistics to the current one
+	 *
+	 *  @param other The statistics that are added
+	 */
+	void add(const yamm_statistics &other) {
+		this->used_bytes += other.used_bytes;
+		this->free_bytes += other.free_bytes;
+		this->number_of_buffers += other.number_of_buffers;
+		this->number_of_free_buffers += other.number_of_free_buffers;
+	}
+
+	/**
+	 *  Subtracts the counters of another set of statistics from the current one
+	 *
+	 *  @param other The statistics that are subtracted
+	 */
+	void subtract(const yamm_statistics &other) {
+		this->used_bytes -= other.used_bytes;
+		this->free_bytes -= other.free_bytes;
+		this->number_of_buffers -= other.number_of_buffers;
+		this->number_of_free_buffers -= other.number_of_free_buffers;
+	}
+
+	/**
+	 *  Returns the percentage of used memory, same as yamm_buffer::get_usage_statistics()
+	 */
+	double get_usage_statistics() {
+		if (used_bytes + free_bytes == 0)
+			return 0;
+		return 1.0 * used_bytes / (used_bytes + free_bytes) * 100;
+	}
+
+	/**
+	 *  Returns the percentage of fragmentation, same as yamm_buffer::get_fragmentation()
+	 */
+	double get_fragmentation() {
+		if (number_of_buffers + number_of_free_buffers == 0)
+			return 0;
+		return 1.0 * number_of_free_buffers
+				/ (number_of_buffers + number_of_free_buffers) * 100;
+	}
+
+};
+
+}
+#endif // __yamm_statistics_h
@@ -0,0 +1,135 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_tlsf
+#define __yamm_tlsf
+
+#include "yamm.h"
+
+using namespace yamm_ns;
+
+void yamm_buffer::tlsf_mapping(uint_64_t size, uint &fl, uint &sl) {
+
+	// Small sizes get one class each
+	if (size < YAMM_TLSF_SL_COUNT) {
+		fl = 0;
+		sl = size;
+		return;
+	}
+
+	// The first level is log2 of the size, the second level splits it linearly
+	uint msb = 63 - __builtin_clzll(size);
+	sl = (size >> (msb - YAMM_TLSF_SL_BITS)) ^ YAMM_TLSF_SL_COUNT;
+	fl = msb - YAMM_TLSF_SL_BITS + 1;
+}
+
+void yamm_buffer::tlsf_insert(yamm_buffer* free_buffer) {
+
+	uint fl, sl;
+	tlsf_mapping(free_buffer->size, fl, sl);
+
+	yamm_buffer* &head = container_state->tlsf_heads[fl * YAMM_TLSF_SL_COUNT + sl];
+
+	free_buffer->tlsf_prev = NULL;
+	free_buffer->tlsf_next = head;
+	if (head)
+		head->tlsf_prev = free_buffer;
+	head = free_buffer;
+
+	container_state->tlsf_sl_bitmaps[fl] |= (1u << sl);
+	container_state->tlsf_fl_bitmap |= (1ull << fl);
+}
+
+void yamm_buffer::tlsf_remove(yamm_buffer* free_buffer) {
+
+	uint fl, sl;
+	tlsf_mapping(free_buffer->size, fl, sl);
+
+	yamm_buffer* &head = container_state->tlsf_heads[fl * YAMM_TLSF_SL_COUNT + sl];
+
+	if (free_buffer->tlsf_prev)
+		free_buffer->tlsf_prev->tlsf_next = free_buffer->tlsf_next;
+	else
+		head = free_buffer->tlsf_next;
+
+	if (free_buffer->tlsf_next)
+		free_buffer->tlsf_next->tlsf_prev = free_buffer->tlsf_prev;
+
+	free_buffer->tlsf_next = NULL;
+	free_buffer->tlsf_prev = NULL;
+
+	if (!head) {
+		container_state->tlsf_sl_bitmaps[fl] &= ~(1u << sl);
+		if (!container_state->tlsf_sl_bitmaps[fl])
+			container_state->tlsf_fl_bitmap &= ~(1ull << fl);
+	}
+}
+
+bool yamm_buffer::allocate_tlsf(yamm_buffer* new_buffer) {
+
+	init_free_buffer();
+
+	// The first TLSF allocation builds the size classes, after that they are kept
+	// up to date by index_free_buffer() and unindex_free_buffer()
+	if (container_state->tlsf_heads.empty()) {
+		container_state->tlsf_heads.resize(YAMM_TLSF_FL_COUNT * YAMM_TLSF_SL_COUNT, NULL);
+		container_state->tlsf_sl_bitmaps.resize(YAMM_TLSF_FL_COUNT, 0);
+		for (std::map<uint_64_t, yamm_buffer*>::iterator it =
+				container_state->free_by_addr.begin();
+				it != container_state->free_by_addr.end(); ++it)
+			tlsf_insert(it->second);
+	}
+
+	// Any free buffer of at least size + alignment - 1 bytes can hold the aligned buffer
+	uint_64_t search_size = new_buffer->size + (new_buffer->start_addr_alignment - 1);
+	if (search_size < new_buffer->size)
+		return 0;
+
+	// Round up to the next class so every free buffer of the class found fits
+	if (search_size >= YAMM_TLSF_SL_COUNT) {
+		uint_64_t round = (1ull
+				<< (63 - __builtin_clzll(search_size) - YAMM_TLSF_SL_BITS)) - 1;
+		if (search_size + round < search_size)
+			return 0;
+		search_size += round;
+	}
+
+	uint fl, sl;
+	tlsf_mapping(search_size, fl, sl);
+
+	// First non-empty class of the same first level, otherwise of the next first levels
+	uint_32_t sl_map = container_state->tlsf_sl_bitmaps[fl] & (~0u << sl);
+	if (!sl_map) {
+		uint_64_t fl_map =
+				(fl + 1 < 64) ? container_state->tlsf_fl_bitmap & (~0ull << (fl + 1)) : 0;
+		if (!fl_map)
+			return 0;
+		fl = __builtin_ctzll(fl_map);
+		sl_map = container_state->tlsf_sl_bitmaps[fl];
+	}
+	sl = __builtin_ctz(sl_map);
+
+	yamm_buffer* temp_free = container_state->tlsf_heads[fl * YAMM_TLSF_SL_COUNT + sl];
+
+	new_buffer->start_addr = get_aligned_addr(new_buffer->start_addr_alignment,
+			new_buffer->start_addr_alignment_mask, temp_free);
+	new_buffer->end_addr = new_buffer->start_addr + new_buffer->size - 1;
+	add(new_buffer, temp_free);
+	return 1;
+}
+
+#endif // __yamm_tlsf
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * (C) Copyright 2016 AMIQ Consulting
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef __yamm_violation_h
+#define __yamm_violation_h
+
+#include <string>
+
+namespace yamm_ns {
+
+#ifndef uint_64_t
+typedef unsigned long long int uint_64_t;
+#endif
+
+/** Size doesn't match the addresses or is 0 */
+#define YAMM_VIOLATION_SIZE 0
+/** Gap or overlap between two neighboring buffers */
+#define YAMM_VIOLATION_CONTINUITY 1
+/** next/prev links don't match */
+#define YAMM_VIOLATION_LINK 2
+/** Two neighboring free buffers weren't merged */
+#define YAMM_VIOLATION_FREE_NOT_MERGED 3
+/** next_free/prev_free links or first_free don't match the free buffers */
+#define YAMM_VIOLATION_FREE_LINK 4
+/** The buffers of a memory map don't cover exactly the buffer that contains them */
+#define YAMM_VIOLATION_COVERAGE 5
+/** The counters of a memory map don't match its buffers */
+#define YAMM_VIOLATION_COUNTER 6
+/** A slot of a slab doesn't match its bit in the bitmap or its buffer */
+#define YAMM_VIOLATION_SLOT 7
+/** The free buffer indexes, the histogram or the statistics of the recursion levels
+ * of a memory map don't match its buffers */
+#define YAMM_VIOLATION_INDEX 8
+
+/**
+ * Class that describes an inconsistency found in a memory map
+ */
+class yamm_violation {
+public:
+
+	/** Kind of inconsistency, one of YAMM_VIOLATION_* */
+	int kind;
+	/** Recursion level of the memory map, 0 is the one that was checked */
+	unsigned int level;
+	/** Start address of the buffer where the inconsistency was found */
+	uint_64_t start_addr;
+	/** End address of the buffer where the inconsistency was found */
+	uint_64_t end_addr;
+	/** Readable description */
+	std::string message;
+
+	yamm_violation(int kind, unsigned int level, uint_64_t start_addr,
+			uint_64_t end_addr, std::string message) {
+		this->kind = kind;
+		this->level = level;
+		this->start_addr = start_addr;
+		this->end_addr = end_addr;
+		this->message = message;
+	}
+
+};
+
+}
+#endif // __yamm_violation_h